@@ -49,9 +49,9 @@ Shader load_shader(const std::string& path) {
 
 void game::load_flyweights() {
     for(auto flyweight_iterator = std::begin(unit_flyweights()); flyweight_iterator != std::end(unit_flyweights()); ++flyweight_iterator) {
-        const float half_width = flyweight_iterator->second.width() / 2.f;
-        const float height = flyweight_iterator->second.height();
-        auto it_value = virtual_textures.find(flyweight_iterator->second.texture());
+        const float half_width = flyweight_iterator->width() / 2.f;
+        const float height = flyweight_iterator->height();
+        auto it_value = virtual_textures.find(flyweight_iterator->texture());
 
         rendering::virtual_texture::area_type area;
         if(it_value != std::end(virtual_textures)) {
@@ -70,7 +70,7 @@ void game::load_flyweights() {
         builder.add_vertex(glm::vec3{ half_width, height, 0.f}, glm::vec2{area.right(), area.bottom()});
         builder.add_vertex(glm::vec3{-half_width, height, 0.f}, glm::vec2{area.left(),  area.bottom()});
 
-        unit_meshes[flyweight_iterator->first] = builder.build();
+        unit_meshes[flyweight_iterator->id()] = builder.build();
     }
 }
 
@@ -238,8 +238,8 @@ void game::setup_inputs() {
             base_unit* selected_unit = units().get(selected_unit_id);
             if(selected_unit) {
                 unit* u = static_cast<unit*>(selected_unit);
-                u->set_target_position(glm::vec2(test.x / rendering::chunk_renderer::SQUARE_SIZE,
-                                                 test.z / rendering::chunk_renderer::SQUARE_SIZE));
+                unit_paths.order(*u, units().stats_of(*u).movement, glm::vec2(test.x / rendering::chunk_renderer::SQUARE_SIZE,
+                                               test.z / rendering::chunk_renderer::SQUARE_SIZE));
 
                 // Send to server
                 //TODO should remove
@@ -264,6 +264,8 @@ void game::load_local_datas() {
 game::game(networking::network_manager& manager, networking::network_manager::socket_handle socket)
 : base_game(std::thread::hardware_concurrency() - 1, std::make_unique<unit_manager>())
 , game_world()
+, pathfinder(game_world)
+, unit_paths(pathfinder)
 , world_rendering(game_world)
 , game_camera(-400.f, 400.f, -400.f, 400.f, -1000.f, 1000.f)
 , last_fps_duration_index(0)
@@ -272,6 +274,8 @@ game::game(networking::network_manager& manager, networking::network_manager::so
 , socket(socket)
 , selected_unit_id(-1)
 , local_visibility(20 * world::CHUNK_WIDTH, 20 * world::CHUNK_DEPTH)
+, next_visibility(20 * world::CHUNK_WIDTH, 20 * world::CHUNK_DEPTH)
+, visibility_changes(20 * world::CHUNK_WIDTH, 20 * world::CHUNK_DEPTH)
 , fow_size(0) {
     last_fps_durations.reserve(10);
     discovered_chunks.reserve(20 * 20);
@@ -370,12 +374,11 @@ void game::wait_for_player_id() {
 void game::wait_for_flyweights() {
     auto flyweights_packet = network.wait_packet_from(PACKET_SETUP_FLYWEIGHTS, socket);
     if (flyweights_packet.first) {
-        auto manager_u = flyweights_packet.second.as<std::unordered_map<std::string, unit_flyweight>>();
-        unit_flyweight_manager manager;
-        for (auto &v : manager_u) {
-            manager.emplace(std::stoi(v.first), std::move(v.second));
+        set_flyweights(flyweights_packet.second.as<std::vector<unit_flyweight>>());
+
+        for(const unit_flyweight& flyweight : unit_flyweights()) {
+            game_world.track_movement(flyweight.movement());
         }
-        set_flyweight_manager(manager);
     }
     else {
         throw std::runtime_error("failed to load flyweights");
@@ -394,6 +397,8 @@ void game::wait_for_initial_chunks() {
             for (const networking::resource &res : received_chunk.sites) {
                 game_chunk.set_site_at(res.x, 0, res.y, site(res.type, res.quantity));
             }
+            game_world.update_walkability(received_chunk.x, received_chunk.y);
+            game_world.update_sites(received_chunk.x, received_chunk.y);
         }
     }
     else {
@@ -416,15 +421,20 @@ void game::poll_chunks_update() {
         auto chunks = p.second.as<std::vector<networking::world_chunk>>();
 
         for(networking::world_chunk& received_chunk : chunks) {
+            // A chunk received again replaces the one already known
+            const bool is_discovered = !game_world.has_chunk(received_chunk.x, received_chunk.y);
             world_chunk& game_chunk = game_world.add(received_chunk.x, received_chunk.y);
             game_chunk.set_biome_at(received_chunk.regions_biome);
+            game_chunk.clear_sites();
 
             for(const networking::resource& res : received_chunk.sites) {
                 game_chunk.set_site_at(res.x, 0, res.y, site(res.type, res.quantity));
             }
+            game_world.update_walkability(received_chunk.x, received_chunk.y);
+            game_world.update_sites(received_chunk.x, received_chunk.y);
+            pathfinder.invalidate(received_chunk.x, received_chunk.y);
 
-            auto it = std::find(std::begin(discovered_chunks), std::end(discovered_chunks), glm::i32vec2(received_chunk.x, received_chunk.y));
-            if(it == std::end(discovered_chunks)) {
+            if(is_discovered) {
                 discovered_chunks.emplace_back(received_chunk.x, received_chunk.y);
             }
         }
@@ -448,8 +458,8 @@ void game::poll_units_update() {
                     my_unit->set_target_position(u.get_target_position());
                 }
             }
-            else {
-                add_unit(u.get_id(), u.get_position(), u.get_target_position(), u.get_type_id());
+            else if(u.type() < unit_flyweights().size()) {
+                add_unit(u.get_id(), u.get_position(), u.get_target_position(), unit_flyweights().definition_of(u.type()).id());
                 game_camera.reset({ u.get_position().x * rendering::chunk_renderer::SQUARE_SIZE,
                                     game_camera.position().y,
                                     u.get_position().z * rendering::chunk_renderer::SQUARE_SIZE });
@@ -476,17 +486,22 @@ void game::cull_out_of_view_chunks() {
 }
 
 void game::on_update(frame_duration last_frame_duration) {
-    std::chrono::milliseconds last_frame_ms = std::chrono::duration_cast<std::chrono::milliseconds>(last_frame_duration);
+    const float elapsed_seconds = std::chrono::duration<float>(last_frame_duration).count();
 
-    auto visibility_task = push_task(std::make_unique<task::update_player_visibility>(player_id, local_visibility, units()));
+    // Reads the units of the last frame while they are updated
+    auto visibility_task = push_task(std::make_unique<task::update_player_visibility>(player_id, visibility_changes, local_visibility, next_visibility, units().snapshot(), unit_flyweights()));
 
     poll_server_changes();
 
-    auto update_task = push_task(std::make_unique<task::update_units>(units(), game_world, last_frame_ms.count() / 1000.0f));
+    unit_paths.advance(units());
+
+    const std::vector<glm::vec2>& pushes = separate_units();
+    auto update_task = push_task(std::make_unique<task::update_units>(units(), game_world, elapsed_seconds, pushes));
 
     inputs.dispatch();
 
     update_task.wait();
+    units().publish_snapshot();
 
     cull_out_of_view_chunks();
 
@@ -494,7 +509,7 @@ void game::on_update(frame_duration last_frame_duration) {
     auto visiblity_ptr = visibility_task.get();
     auto visibility_task_ptr = static_cast<task::update_player_visibility*>(visiblity_ptr.get());
     if(visibility_task_ptr) {
-        local_visibility = visibility_task_ptr->visibility();
+        local_visibility.swap(next_visibility);
 
         // TODO: Only update if changed
         update_fog_of_war();
@@ -605,26 +620,28 @@ void game::render_chunks() {
 }
 
 void game::render_units() {
+    const unit_manager::snapshot_ptr current_state = units().snapshot();
+
 	// render selection
-	if (selected_unit_id != -1)
+	const unit* selected_unit = selected_unit_id != -1 ? current_state->find(selected_unit_id) : nullptr;
+	if (selected_unit)
 	{
-		base_unit* selected_unit = units().get(selected_unit_id);
-
 		rendering::mesh_renderer renderer(&selection_meshes[0],
 			glm::scale(
 				glm::translate(glm::mat4(1.f), selected_unit->get_position() * rendering::chunk_renderer::SQUARE_SIZE + glm::vec3(0.f, 1.f, 0.f)),
-			    glm::vec3(selected_unit->get_flyweight()->width() * 0.5f, 1, selected_unit->get_flyweight()->width() * 0.5f))
+			    glm::vec3(units().stats_of(*selected_unit).width * 0.5f, 1, units().stats_of(*selected_unit).width * 0.5f))
 			, virtual_textures["Selection"].id, PROGRAM_STANDARD, 1);
 
 		mesh_rendering.push(std::move(renderer));
 	}
 
-    for(auto unit = units().begin_of_units(); unit != units().end_of_units(); ++unit) {
-        if(unit->second->is_visible()) {
-            rendering::mesh_renderer renderer(&unit_meshes[unit->second->get_type_id()],
-                                              glm::translate(glm::mat4{1.f}, unit->second->get_position() *
+    for(const unit& u : *current_state) {
+        if(u.is_visible()) {
+            const unit_flyweight& definition = unit_flyweights().definition_of(u.type());
+            rendering::mesh_renderer renderer(&unit_meshes[definition.id()],
+                                              glm::translate(glm::mat4{1.f}, u.get_position() *
                                                                              rendering::chunk_renderer::SQUARE_SIZE),
-                                              virtual_textures[unit->second->texture()].id, PROGRAM_BILLBOARD, 2);
+                                              virtual_textures[definition.texture()].id, PROGRAM_BILLBOARD, 2);
             mesh_rendering.push(std::move(renderer));
         }
     }
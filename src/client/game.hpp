@@ -14,6 +14,9 @@
 #include "../common/game/base_game.hpp"
 #include "../common/networking/network_manager.hpp"
 #include "../common/world/visibility_map.hpp"
+#include "../common/world/visibility_tracker.hpp"
+#include "../common/pathfinding/hierarchical_pathfinder.hpp"
+#include "../common/pathfinding/path_follower.hpp"
 #include "../common/memory/static_vector.hpp"
 #include "opengl/frame_buffer.hpp"
 #include "opengl/render_buffer.hpp"
@@ -42,6 +45,8 @@ private:
 
     // World
     world game_world;
+    pathfinding::hierarchical_pathfinder pathfinder;
+    pathfinding::path_follower unit_paths;
 
 	// Selection
 	static const int MAX_SELECTED_UNITS = 12;
@@ -70,6 +75,8 @@ private:
     networking::network_manager::socket_handle socket;
 
     visibility_map local_visibility;
+    visibility_map next_visibility;
+    visibility_tracker visibility_changes;
     gl::vertex_array fow_vao;
     gl::buffer fow_vertices;
     gl::buffer fow_colors;
@@ -129,8 +129,8 @@ rendering::static_mesh_builder<world::CHUNK_WIDTH * world::CHUNK_DEPTH * 36> chu
         for (std::size_t z = 0; z < world::CHUNK_DEPTH; ++z) {
             auto sites = chunk.sites_at(x, 0, z);
 
-            if (sites.size() > 0 && sites.front()->type() != SITE_NOTHING) {
-                const glm::vec3 SITE_COLOR = get_site_color(sites.front()->type());
+            if (sites.size() > 0 && sites.front().type() != SITE_NOTHING) {
+                const glm::vec3 SITE_COLOR = get_site_color(sites.front().type());
                 rendering::make_cube(sites_builder, SITE_SIZE, SITE_COLOR,
                                      glm::vec3{x * SQUARE_SIZE + (SQUARE_SIZE / 4.f), 0.f,
                                                z * SQUARE_SIZE + (SQUARE_SIZE / 4.f)});
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 
 
@@ -141,6 +142,30 @@ public:
 
         --position;
     }
+
+    // The kept values stay in order and are moved once, sorted_keys must be sorted
+    template<typename Key>
+    void remove_all(const std::vector<Key>& sorted_keys)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < position; ++i)
+        {
+            if (std::binary_search(sorted_keys.begin(), sorted_keys.end(), static_cast<Key>(keys[i])))
+            {
+                continue;
+            }
+
+            if (kept != i)
+            {
+                keys[kept] = keys[i];
+                values[kept] = std::move(values[i]);
+            }
+            ++kept;
+        }
+
+        position = kept;
+    }
+
     size_t size() const
     {
         return position - 1;
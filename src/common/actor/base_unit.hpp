@@ -3,34 +3,40 @@
 
 #include "actor.hpp"
 #include "unit_flyweight.hpp"
+#include "flyweight_table.hpp"
 
 #include <json/json.hpp>
 
 class base_unit : public actor
 {
-    unit_flyweight* flyweight;
-    int flyweight_id;
+    // Dense index in the flyweight table of the unit manager, the stats are looked up there
+    flyweight_index type_index;
 
     int current_health;
+    float attack_cooldown_ = 0.f;
+
+    // Simulation time skipped while the unit was updated at a lower rate
+    float deferred_seconds_ = 0.f;
+    bool is_deferred_ = false;
     uint32_t id;
 
 public:
-    base_unit(glm::vec3 position = {}, unit_flyweight* definition = nullptr, actor_type type = actor_type::MAX_ACTOR_TYPE)
-    : actor(position, true, true, type)
-    , flyweight(definition)
-    , flyweight_id(flyweight ? flyweight->id() : unit_flyweight::INVALID_ID)
-    , current_health(flyweight ? flyweight->get_max_health() : 0) {
+    base_unit(glm::vec3 position = {}, flyweight_index type = flyweight_table::INVALID_INDEX, int health = 0,
+              actor_type actor_kind = actor_type::MAX_ACTOR_TYPE)
+    : actor(position, true, true, actor_kind)
+    , type_index(type)
+    , current_health(health) {
+
+    }
 
+    void set_type(const flyweight_table& flyweights, flyweight_index new_type) {
+        type_index = new_type;
+        current_health = flyweights.stats_of(new_type).max_health;
     }
 
-    void set_flyweight(unit_flyweight* new_flyweight) {
-        flyweight = new_flyweight;
-        current_health = flyweight->get_max_health();
-    } 
-	
-	unit_flyweight* get_flyweight() {
-		return flyweight;
-	}
+    flyweight_index type() const noexcept {
+        return type_index;
+    }
 
     void take_damage(unsigned int damage)
     {
@@ -47,29 +53,48 @@ public:
         return current_health <= 0;
     }
 
-    void set_id(uint32_t new_id) noexcept {
-        id = new_id;
+    int health() const noexcept {
+        return current_health;
     }
 
-    uint32_t get_id() const noexcept {
-        return id;
+    void set_health(int health) noexcept {
+        current_health = health;
     }
 
-    int get_type_id() const noexcept {
-        return flyweight_id;
+    float attack_cooldown() const noexcept {
+        return attack_cooldown_;
     }
 
-	float get_speed()
-	{
-		return flyweight->get_speed();
-	}
+    void set_attack_cooldown(float seconds) noexcept {
+        attack_cooldown_ = seconds;
+    }
+
+    // Skips the unit for this tick, the time is caught up on its next update
+    void defer(float seconds) noexcept {
+        deferred_seconds_ += seconds;
+        is_deferred_ = true;
+    }
 
-    const std::string& texture() const noexcept {
-        return flyweight->texture();
+    void undefer() noexcept {
+        is_deferred_ = false;
     }
 
-    float visibility_radius() const noexcept {
-        return flyweight->visibility();
+    bool is_deferred() const noexcept {
+        return is_deferred_;
+    }
+
+    float take_deferred_seconds() noexcept {
+        const float seconds = deferred_seconds_;
+        deferred_seconds_ = 0.f;
+        return seconds;
+    }
+
+    void set_id(uint32_t new_id) noexcept {
+        id = new_id;
+    }
+
+    uint32_t get_id() const noexcept {
+        return id;
     }
 
     friend void from_json(const nlohmann::json& j, base_unit& u);
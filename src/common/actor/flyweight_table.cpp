@@ -0,0 +1,63 @@
+#include "flyweight_table.hpp"
+
+#include <cassert>
+
+unit_stats flyweight_table::make_stats(const unit_flyweight& flyweight) noexcept {
+    unit_stats hot;
+    hot.speed = flyweight.get_speed();
+    hot.visibility_radius = flyweight.visibility();
+    hot.width = flyweight.width();
+    hot.range = flyweight.get_range();
+    hot.attack_speed = flyweight.get_attack_speed();
+    hot.max_health = flyweight.get_max_health();
+    hot.damage = flyweight.get_damage();
+    hot.armor = flyweight.get_armor();
+    hot.movement = flyweight.movement();
+
+    return hot;
+}
+
+flyweight_index flyweight_table::add(const unit_flyweight& flyweight) {
+    auto it = indices.find(flyweight.id());
+    if(it != indices.end()) {
+        stats[it->second] = make_stats(flyweight);
+        definitions[it->second] = flyweight;
+
+        return it->second;
+    }
+
+    assert(definitions.size() < INVALID_INDEX);
+    const auto index = static_cast<flyweight_index>(definitions.size());
+    stats.push_back(make_stats(flyweight));
+    definitions.push_back(flyweight);
+    indices.emplace(flyweight.id(), index);
+
+    return index;
+}
+
+void flyweight_table::clear() noexcept {
+    stats.clear();
+    definitions.clear();
+    indices.clear();
+}
+
+flyweight_index flyweight_table::index_of(int flyweight_id) const noexcept {
+    auto it = indices.find(flyweight_id);
+    if(it == indices.end()) {
+        return INVALID_INDEX;
+    }
+
+    return it->second;
+}
+
+std::size_t flyweight_table::size() const noexcept {
+    return definitions.size();
+}
+
+flyweight_table::iterator flyweight_table::begin() const noexcept {
+    return definitions.begin();
+}
+
+flyweight_table::iterator flyweight_table::end() const noexcept {
+    return definitions.end();
+}
@@ -0,0 +1,74 @@
+#ifndef MMAP_DEMO_FLYWEIGHT_TABLE_HPP
+#define MMAP_DEMO_FLYWEIGHT_TABLE_HPP
+
+#include "unit_flyweight.hpp"
+#include "../world/movement_class.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+using flyweight_index = uint16_t;
+
+// Stats read every tick, two of them fit in a cache line
+struct unit_stats {
+    float speed;
+    float visibility_radius;
+    float width;
+    float range;
+    float attack_speed;
+    int32_t max_health;
+    uint16_t damage;
+    int16_t armor;
+    movement_class movement;
+};
+
+static_assert(sizeof(unit_stats) <= 32, "unit stats must stay packed");
+
+// Radius of the circle of a unit, in tiles
+inline float collision_radius(const unit_stats& stats) noexcept {
+    static const float WIDTH_TO_TILE_RATIO = 1 / 45.f;
+    return stats.width * WIDTH_TO_TILE_RATIO;
+}
+
+// Flyweights stored contiguously and addressed by a dense index,
+// the hot stats are kept apart from the rest of the definition
+class flyweight_table {
+public:
+    using definition_collection = std::vector<unit_flyweight>;
+    using iterator = definition_collection::const_iterator;
+
+    static constexpr flyweight_index INVALID_INDEX = std::numeric_limits<flyweight_index>::max();
+private:
+    std::vector<unit_stats> stats;
+    definition_collection definitions;
+    std::unordered_map<int, flyweight_index> indices;
+
+    static unit_stats make_stats(const unit_flyweight& flyweight) noexcept;
+
+public:
+    // Replaces the flyweight with the same id if there is one
+    flyweight_index add(const unit_flyweight& flyweight);
+    void clear() noexcept;
+
+    flyweight_index index_of(int flyweight_id) const noexcept;
+
+    const unit_stats& stats_of(flyweight_index index) const noexcept {
+        assert(index < stats.size());
+        return stats[index];
+    }
+
+    const unit_flyweight& definition_of(flyweight_index index) const noexcept {
+        assert(index < definitions.size());
+        return definitions[index];
+    }
+
+    std::size_t size() const noexcept;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+};
+
+#endif //MMAP_DEMO_FLYWEIGHT_TABLE_HPP
@@ -2,21 +2,21 @@
 
 
 unit::unit() 
-	: base_unit({0,0,0}, nullptr, actor_type::unit),
+	: base_unit({0,0,0}, flyweight_table::INVALID_INDEX, 0, actor_type::unit),
 	transported_ressource{},
 	target{ nullptr },
 	target_position{0,0}
 { }
 
-unit::unit(glm::vec3 position, glm::vec2 target_position, unit_flyweight* unit_fly, unit_manager* manager) :
-base_unit(position, unit_fly, actor_type::unit),
+unit::unit(glm::vec3 position, glm::vec2 target_position, const flyweight_table& flyweights, flyweight_index type, unit_manager* manager) :
+base_unit(position, type, flyweights.stats_of(type).max_health, actor_type::unit),
 transported_ressource{},
 target{manager},
 target_position{target_position}
 {}
 
-unit::unit(glm::vec3 position, unit_flyweight* unit_fly, unit_manager* manager) :
-	base_unit(position, unit_fly, actor_type::unit),
+unit::unit(glm::vec3 position, const flyweight_table& flyweights, flyweight_index type, unit_manager* manager) :
+	base_unit(position, type, flyweights.stats_of(type).max_health, actor_type::unit),
 	transported_ressource{},
 	target{ manager },
 	target_position{ position }
@@ -19,8 +19,8 @@ class unit : public base_unit
     glm::vec2 target_position;
 public:
 	unit();
-    unit(glm::vec3 position, glm::vec2 target_position, unit_flyweight* unit_fly, unit_manager* manager);
-	unit(glm::vec3 position, unit_flyweight* unit_fly, unit_manager* manager);
+    unit(glm::vec3 position, glm::vec2 target_position, const flyweight_table& flyweights, flyweight_index type, unit_manager* manager);
+	unit(glm::vec3 position, const flyweight_table& flyweights, flyweight_index type, unit_manager* manager);
     void set_target(target_handle _target);
     target_handle& get_target();
     void set_target_position(glm::vec2 _target_position);
@@ -4,6 +4,7 @@
 #include "ressource_value.hpp"
 #include "ressource_type.hpp"
 #include "../world/biome_type.hpp"
+#include "../world/movement_class.hpp"
 
 #include <json/json.hpp>
 #include <vector>
@@ -18,6 +19,7 @@ private:
     std::vector<ressource_type> ressource_gathering_type;
     std::vector<ressource_type> ressource_drop_off;
     std::vector<biome_type> walkable_biome;
+    movement_class walkable_mask = 0;
     std::vector<int> buildable_unit_id_list;
     ressource_value unit_cost;
     std::string name;
@@ -44,20 +46,40 @@ public:
         load_unit_from_json(data);
     }
 
-    int get_max_health()
+    int get_max_health() const
     {
         return max_health;
     }
 
-    uint8_t get_tranport_unit_capacity()
+    uint8_t get_tranport_unit_capacity() const
     {
         return tranport_unit_capacity;
     }
 
-	float get_speed()
+	float get_speed() const
 	{
 		return speed;
 	}
+
+    float get_attack_speed() const
+    {
+        return attack_speed;
+    }
+
+    float get_range() const
+    {
+        return range;
+    }
+
+    uint16_t get_damage() const
+    {
+        return damage;
+    }
+
+    int16_t get_armor() const
+    {
+        return armor;
+    }
     
     void load_unit_from_json(const nlohmann::json& json)
     {
@@ -110,6 +132,7 @@ public:
             if (name == "Water") return biome_type::water;
             return biome_type::unknown;
         });
+        walkable_mask = make_movement_class(walkable_biome);
         transportable = json["Transportable"];
         population_cost = json["PopulationCost"];
         height_ = json["Height"];
@@ -172,6 +195,10 @@ public:
         return visibility_radius;
     }
 
+    movement_class movement() const noexcept {
+        return walkable_mask;
+    }
+
     friend void to_json(nlohmann::json& j, const unit_flyweight& uf);
 };
 
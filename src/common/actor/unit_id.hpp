@@ -0,0 +1,28 @@
+#ifndef MMAP_DEMO_UNIT_ID_HPP
+#define MMAP_DEMO_UNIT_ID_HPP
+
+#include <cstdint>
+
+struct unit_id
+{
+    uint8_t player_id = 0;
+    uint8_t unit_type = 0;
+    uint16_t counter  = 0;
+
+    unit_id() = default;
+    unit_id(uint32_t v) {
+        from_uint32_t(v);
+    }
+
+    uint32_t to_uint32_t() const
+    {
+        return *reinterpret_cast<const uint32_t*>(this);
+    }
+
+    void from_uint32_t(uint32_t val)
+    {
+        *this = *reinterpret_cast<unit_id*>(&val);
+    }
+};
+
+#endif //MMAP_DEMO_UNIT_ID_HPP
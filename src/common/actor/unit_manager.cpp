@@ -1,6 +1,11 @@
 #include "unit_manager.hpp"
 #include "../collision/collision_detector.hpp"
 
+unit_manager::unit_manager()
+: published_snapshot(std::make_shared<unit_snapshot>()) {
+
+}
+
 uint32_t unit_manager::get_unit_type(uint32_t id)
 {
     return id & 0x0ff0000;
@@ -15,20 +20,34 @@ base_unit* unit_manager::get(uint32_t id)
 {
     unit_id id_parts(id);
     uint32_t type = id_parts.unit_type;
-    if (type == 0 && units.contains(id))
+    if (type == 0)
     {
         std::lock_guard<std::mutex> lock(units_mutex);
-        return &units[id];
+        if (units.contains(id))
+        {
+            return &units[id];
+        }
     }
-    else if (type == 1 && buildings.contains(id))
+    else if (type == 1)
     {
         std::lock_guard<std::mutex> lock(buildings_mutex);
-        return &buildings[id];
+        if (buildings.contains(id))
+        {
+            return &buildings[id];
+        }
     }
 
     return nullptr;
 }
 
+flyweight_table& unit_manager::flyweights() noexcept {
+    return unit_flyweights;
+}
+
+const flyweight_table& unit_manager::flyweights() const noexcept {
+    return unit_flyweights;
+}
+
 target_handle unit_manager::add(unit _unit, uint32_t id)
 {
     std::lock_guard<std::mutex> lock(units_mutex);
@@ -77,6 +96,21 @@ void unit_manager::remove(uint32_t id)
     }
 }
 
+void unit_manager::remove_all(const std::vector<uint32_t>& ids)
+{
+    std::vector<uint32_t> sorted_ids(ids);
+    std::sort(sorted_ids.begin(), sorted_ids.end());
+
+    {
+        std::lock_guard<std::mutex> lock(units_mutex);
+        units.remove_all(sorted_ids);
+    }
+    {
+        std::lock_guard<std::mutex> lock(buildings_mutex);
+        buildings.remove_all(sorted_ids);
+    }
+}
+
 unit_manager::unit_iterator unit_manager::begin_of_units() {
     return units.begin();
 }
@@ -102,3 +136,43 @@ size_t unit_manager::count_buildings() const noexcept {
     std::lock_guard<std::mutex> lock(buildings_mutex);
     return buildings.size();
 }
+
+void unit_manager::publish_snapshot() {
+    // A buffer only held by this manager cannot be read anymore, the published one is always shared
+    std::shared_ptr<unit_snapshot> back_buffer;
+    for(std::shared_ptr<unit_snapshot>& buffer : snapshot_buffers) {
+        if(!buffer) {
+            buffer = std::make_shared<unit_snapshot>();
+        }
+
+        if(buffer.use_count() == 1) {
+            back_buffer = buffer;
+            break;
+        }
+    }
+
+    // Every buffer is still read, this one is dropped by the last reader
+    if(!back_buffer) {
+        back_buffer = std::make_shared<unit_snapshot>();
+    }
+
+    back_buffer->units.clear();
+    {
+        std::lock_guard<std::mutex> lock(units_mutex);
+        back_buffer->units.reserve(units.size());
+        for(auto it = std::begin(units); it != std::end(units); ++it) {
+            back_buffer->units.push_back(*it->second);
+        }
+    }
+
+    std::sort(std::begin(back_buffer->units), std::end(back_buffer->units), [](const unit& a, const unit& b) {
+        return a.get_id() < b.get_id();
+    });
+    back_buffer->epoch_ = ++snapshot_epoch;
+
+    std::atomic_store(&published_snapshot, snapshot_ptr(back_buffer));
+}
+
+unit_manager::snapshot_ptr unit_manager::snapshot() const {
+    return std::atomic_load(&published_snapshot);
+}
@@ -5,6 +5,8 @@
 #include "unit.hpp"
 #include "building.hpp"
 #include "target_handle.hpp"
+#include "unit_id.hpp"
+#include "unit_snapshot.hpp"
 #include "../collision/circle_shape.hpp"
 #include "../collision/collision_detector.hpp"
 #include "../memory/arena.hpp"
@@ -18,28 +20,6 @@
 #include <array>
 #include <mutex>
 
-struct unit_id
-{
-    uint8_t player_id = 0;
-    uint8_t unit_type = 0;
-    uint16_t counter  = 0;
-
-    unit_id() = default;
-    unit_id(uint32_t v) {
-        from_uint32_t(v);
-    }
-
-    uint32_t to_uint32_t() const
-    {
-        return *reinterpret_cast<const uint32_t*>(this);
-    }
-
-    void from_uint32_t(uint32_t val)
-    {
-        *this = *reinterpret_cast<unit_id*>(&val);
-    }
-};
-
 class unit_manager
 {
     static const size_t MAX_UNIT = 400;
@@ -47,7 +27,10 @@ public:
     using unit_ptr = std::unique_ptr<base_unit>;
     using unit_iterator = array_map<unit, MAX_UNIT>::iterator;
     using building_iterator = array_map<building, MAX_UNIT>::iterator;
+    using snapshot_ptr = std::shared_ptr<const unit_snapshot>;
 private:
+    static const size_t SNAPSHOT_BUFFER_COUNT = 3;
+
     mutable std::mutex units_mutex;
     mutable std::mutex buildings_mutex;
     std::array<std::unordered_map<uint32_t, unit_ptr>, 3> manager_data;
@@ -55,8 +38,26 @@ private:
     array_map<unit, MAX_UNIT> units{};
     array_map<building, MAX_UNIT> buildings{};
 
+    // Units only keep their index in this table
+    flyweight_table unit_flyweights;
+
+    // Buffers are recycled once no reader holds them anymore
+    std::array<std::shared_ptr<unit_snapshot>, SNAPSHOT_BUFFER_COUNT> snapshot_buffers;
+    snapshot_ptr published_snapshot;
+    uint64_t snapshot_epoch = 0;
+
+    // Scratch of the shape queries, guarded by the mutex of the units or of the buildings
+    collision::circle_batch unit_circles;
+    collision::circle_batch building_circles;
+    collision::hit_mask unit_hits;
+    collision::hit_mask building_hits;
+
+    static bool is_hit(const collision::hit_mask& hits, std::size_t index) noexcept {
+        return ((hits[index / 64] >> (index % 64)) & 1) != 0;
+    }
+
 public:
-    unit_manager() = default;
+    unit_manager();
 
     uint32_t get_unit_type(uint32_t id);
 
@@ -64,11 +65,21 @@ public:
 
     base_unit* get(uint32_t id);
 
+    flyweight_table& flyweights() noexcept;
+    const flyweight_table& flyweights() const noexcept;
+
+    const unit_stats& stats_of(const base_unit& u) const noexcept {
+        return unit_flyweights.stats_of(u.type());
+    }
+
     target_handle add(unit _unit, uint32_t id);
     target_handle add(building _unit, uint32_t id);
 
     void remove(uint32_t id);
 
+    // Compacts the units and the buildings once, however many ids are removed
+    void remove_all(const std::vector<uint32_t>& ids);
+
     unit_iterator begin_of_units();
     unit_iterator end_of_units();
     std::size_t count_units() const noexcept;
@@ -77,6 +88,12 @@ public:
     building_iterator end_of_buildings();
     size_t count_buildings() const noexcept;
 
+    // Must be called by the simulation at the end of a tick
+    void publish_snapshot();
+
+    // The units as they were when last published, safe to read from any thread
+    snapshot_ptr snapshot() const;
+
     template <class output_iterator>
     output_iterator units_of(uint8_t player_id, output_iterator ot) {
         std::lock_guard<std::mutex> lock(units_mutex);
@@ -97,10 +114,17 @@ public:
         std::lock_guard<std::mutex> lock(units_mutex);
         static_assert(collision::is_collision_shape<CollisionShape>::value, "you must specify a collision shape");
 
+        unit_circles.clear();
         for(auto it = std::begin(units); it != std::end(units); ++it) {
-			static const float select_unit_to_chunk_ratio = 1 / 45.f;
+            const unit* u = it->second;
+            unit_circles.push_back(glm::vec2(u->get_position().x, u->get_position().z), collision_radius(stats_of(*u)));
+        }
+        collision::detect(shape, unit_circles, unit_hits);
+
+        std::size_t i = 0;
+        for(auto it = std::begin(units); it != std::end(units); ++it, ++i) {
             unit* u = it->second;
-            if(collision::detect(collision::circle_shape(glm::vec2(u->get_position().x, u->get_position().z), select_unit_to_chunk_ratio * u->get_flyweight()->width()), shape) && pred(u)) {
+            if(is_hit(unit_hits, i) && pred(u)) {
                 *ot = u;
                 ++ot;
             }
@@ -124,14 +148,22 @@ public:
         return ot;
     }
 
-    template<typename CollisionShape, typename OutputIterator, typename pred>
-    OutputIterator buildings_in(CollisionShape shape, OutputIterator ot, pred) {
+    template<typename CollisionShape, typename OutputIterator, typename predicate>
+    OutputIterator buildings_in(CollisionShape shape, OutputIterator ot, predicate pred) {
         std::lock_guard<std::mutex> lock(buildings_mutex);
         static_assert(collision::is_collision_shape<CollisionShape>::value, "you must specify a collision shape");
 
+        building_circles.clear();
         for (auto it = std::begin(buildings); it != std::end(buildings); ++it) {
+            const building* u = it->second;
+            building_circles.push_back(glm::vec2(u->get_position().x, u->get_position().z), 1.5f);
+        }
+        collision::detect(shape, building_circles, building_hits);
+
+        std::size_t i = 0;
+        for (auto it = std::begin(buildings); it != std::end(buildings); ++it, ++i) {
             building* u = it->second;
-            if (collision::detect(collision::circle_shape(glm::vec2(u->get_position().x, u->get_position().z), 1.5), shape), pred(u)) {
+            if (is_hit(building_hits, i) && pred(u)) {
                 *ot = u;
                 ++ot;
             }
@@ -0,0 +1,31 @@
+#include "unit_snapshot.hpp"
+
+#include <algorithm>
+
+uint64_t unit_snapshot::epoch() const noexcept {
+    return epoch_;
+}
+
+unit_snapshot::const_iterator unit_snapshot::begin() const noexcept {
+    return units.begin();
+}
+
+unit_snapshot::const_iterator unit_snapshot::end() const noexcept {
+    return units.end();
+}
+
+std::size_t unit_snapshot::size() const noexcept {
+    return units.size();
+}
+
+const unit* unit_snapshot::find(uint32_t id) const noexcept {
+    auto it = std::lower_bound(units.begin(), units.end(), id, [](const unit& u, uint32_t id) {
+        return u.get_id() < id;
+    });
+
+    if(it == units.end() || it->get_id() != id) {
+        return nullptr;
+    }
+
+    return &(*it);
+}
@@ -0,0 +1,44 @@
+#ifndef MMAP_DEMO_UNIT_SNAPSHOT_HPP
+#define MMAP_DEMO_UNIT_SNAPSHOT_HPP
+
+#include "unit.hpp"
+#include "unit_id.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Immutable copy of every unit at the end of a tick, readers never lock
+class unit_snapshot {
+public:
+    using unit_collection = std::vector<unit>;
+    using const_iterator = unit_collection::const_iterator;
+private:
+    uint64_t epoch_ = 0;
+
+    // Sorted by id
+    unit_collection units;
+
+    friend class unit_manager;
+public:
+    uint64_t epoch() const noexcept;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    std::size_t size() const noexcept;
+
+    const unit* find(uint32_t id) const noexcept;
+
+    template<typename OutputIterator>
+    OutputIterator units_of(uint8_t player_id, OutputIterator ot) const {
+        for(const unit& u : units) {
+            if(unit_id(u.get_id()).player_id == player_id) {
+                *ot = &u;
+                ++ot;
+            }
+        }
+
+        return ot;
+    }
+};
+
+#endif //MMAP_DEMO_UNIT_SNAPSHOT_HPP
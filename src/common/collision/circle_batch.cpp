@@ -0,0 +1,230 @@
+#include "circle_batch.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MMAP_DEMO_BATCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MMAP_DEMO_BATCH_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace collision {
+
+namespace {
+
+// Every test is the distance between the center of a circle and a box,
+// a point is an empty box and a circle is a point with a wider reach
+struct box_query {
+    float min_x;
+    float max_x;
+    float min_y;
+    float max_y;
+    float extra_reach;
+};
+
+box_query make_query(glm::vec2 point) noexcept {
+    return box_query{point.x, point.x, point.y, point.y, 0.f};
+}
+
+box_query make_query(const circle_shape& shape) noexcept {
+    return box_query{shape.center().x, shape.center().x, shape.center().y, shape.center().y, shape.radius()};
+}
+
+box_query make_query(const aabb_shape& shape) noexcept {
+    return box_query{shape.left(), shape.right(), shape.bottom(), shape.top(), 0.f};
+}
+
+bool test_one(const box_query& query, float x, float y, float radius) noexcept {
+    const float dx = x - std::min(std::max(x, query.min_x), query.max_x);
+    const float dy = y - std::min(std::max(y, query.min_y), query.max_y);
+    const float reach = radius + query.extra_reach;
+
+    return dx * dx + dy * dy <= reach * reach;
+}
+
+void detect_range_scalar(const box_query& query, const circle_batch& circles, std::size_t first, hit_mask& hits) {
+    const float* xs = circles.x_data();
+    const float* ys = circles.y_data();
+    const float* radii = circles.radius_data();
+
+    for(std::size_t i = first; i < circles.size(); ++i) {
+        if(test_one(query, xs[i], ys[i], radii[i])) {
+            hits[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+}
+
+void prepare(const circle_batch& circles, hit_mask& hits) {
+    hits.assign((circles.size() + 63) / 64, 0);
+}
+
+#if defined(MMAP_DEMO_BATCH_AVX2)
+void detect_range(const box_query& query, const circle_batch& circles, hit_mask& hits) {
+    const __m256 min_x = _mm256_set1_ps(query.min_x);
+    const __m256 max_x = _mm256_set1_ps(query.max_x);
+    const __m256 min_y = _mm256_set1_ps(query.min_y);
+    const __m256 max_y = _mm256_set1_ps(query.max_y);
+    const __m256 extra_reach = _mm256_set1_ps(query.extra_reach);
+
+    const std::size_t vector_end = circles.size() - circles.size() % 8;
+    for(std::size_t i = 0; i < vector_end; i += 8) {
+        const __m256 x = _mm256_loadu_ps(circles.x_data() + i);
+        const __m256 y = _mm256_loadu_ps(circles.y_data() + i);
+        const __m256 dx = _mm256_sub_ps(x, _mm256_min_ps(_mm256_max_ps(x, min_x), max_x));
+        const __m256 dy = _mm256_sub_ps(y, _mm256_min_ps(_mm256_max_ps(y, min_y), max_y));
+        const __m256 reach = _mm256_add_ps(_mm256_loadu_ps(circles.radius_data() + i), extra_reach);
+
+        const __m256 distance_sq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const int bits = _mm256_movemask_ps(_mm256_cmp_ps(distance_sq, _mm256_mul_ps(reach, reach), _CMP_LE_OQ));
+        hits[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+    }
+
+    detect_range_scalar(query, circles, vector_end, hits);
+}
+#elif defined(MMAP_DEMO_BATCH_SSE2)
+void detect_range(const box_query& query, const circle_batch& circles, hit_mask& hits) {
+    const __m128 min_x = _mm_set1_ps(query.min_x);
+    const __m128 max_x = _mm_set1_ps(query.max_x);
+    const __m128 min_y = _mm_set1_ps(query.min_y);
+    const __m128 max_y = _mm_set1_ps(query.max_y);
+    const __m128 extra_reach = _mm_set1_ps(query.extra_reach);
+
+    const std::size_t vector_end = circles.size() - circles.size() % 4;
+    for(std::size_t i = 0; i < vector_end; i += 4) {
+        const __m128 x = _mm_loadu_ps(circles.x_data() + i);
+        const __m128 y = _mm_loadu_ps(circles.y_data() + i);
+        const __m128 dx = _mm_sub_ps(x, _mm_min_ps(_mm_max_ps(x, min_x), max_x));
+        const __m128 dy = _mm_sub_ps(y, _mm_min_ps(_mm_max_ps(y, min_y), max_y));
+        const __m128 reach = _mm_add_ps(_mm_loadu_ps(circles.radius_data() + i), extra_reach);
+
+        const __m128 distance_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const int bits = _mm_movemask_ps(_mm_cmple_ps(distance_sq, _mm_mul_ps(reach, reach)));
+        hits[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+    }
+
+    detect_range_scalar(query, circles, vector_end, hits);
+}
+#else
+void detect_range(const box_query& query, const circle_batch& circles, hit_mask& hits) {
+    detect_range_scalar(query, circles, 0, hits);
+}
+#endif
+
+int lowest_bit(uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while(((word >> index) & 1) == 0) {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+}
+
+void circle_batch::clear() noexcept {
+    xs.clear();
+    ys.clear();
+    radii.clear();
+}
+
+void circle_batch::reserve(std::size_t count) {
+    xs.reserve(count);
+    ys.reserve(count);
+    radii.reserve(count);
+}
+
+void circle_batch::push_back(glm::vec2 center, float radius) {
+    xs.push_back(center.x);
+    ys.push_back(center.y);
+    radii.push_back(radius);
+}
+
+void circle_batch::push_back(const circle_shape& circle) {
+    push_back(circle.center(), circle.radius());
+}
+
+std::size_t circle_batch::size() const noexcept {
+    return xs.size();
+}
+
+bool circle_batch::empty() const noexcept {
+    return xs.empty();
+}
+
+const float* circle_batch::x_data() const noexcept {
+    return xs.data();
+}
+
+const float* circle_batch::y_data() const noexcept {
+    return ys.data();
+}
+
+const float* circle_batch::radius_data() const noexcept {
+    return radii.data();
+}
+
+const char* batch_instruction_set() noexcept {
+#if defined(MMAP_DEMO_BATCH_AVX2)
+    return "avx2";
+#elif defined(MMAP_DEMO_BATCH_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void detect(glm::vec2 point, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range(make_query(point), circles, hits);
+}
+
+void detect(const circle_shape& shape, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range(make_query(shape), circles, hits);
+}
+
+void detect(const aabb_shape& shape, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range(make_query(shape), circles, hits);
+}
+
+void detect_scalar(glm::vec2 point, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range_scalar(make_query(point), circles, 0, hits);
+}
+
+void detect_scalar(const circle_shape& shape, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range_scalar(make_query(shape), circles, 0, hits);
+}
+
+void detect_scalar(const aabb_shape& shape, const circle_batch& circles, hit_mask& hits) {
+    prepare(circles, hits);
+    detect_range_scalar(make_query(shape), circles, 0, hits);
+}
+
+std::size_t compact(const hit_mask& hits, std::vector<uint32_t>& indices) {
+    indices.clear();
+    for(std::size_t word = 0; word < hits.size(); ++word) {
+        for(uint64_t bits = hits[word]; bits != 0; bits &= bits - 1) {
+            indices.push_back(static_cast<uint32_t>(word * 64 + lowest_bit(bits)));
+        }
+    }
+
+    return indices.size();
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef MMAP_DEMO_CIRCLE_BATCH_HPP
+#define MMAP_DEMO_CIRCLE_BATCH_HPP
+
+#include "aabb_shape.hpp"
+#include "circle_shape.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace collision {
+
+// Circles stored as separate arrays of coordinates and radii so the kernels
+// load several consecutive circles in a single register
+class circle_batch {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> radii;
+public:
+    void clear() noexcept;
+    void reserve(std::size_t count);
+    void push_back(glm::vec2 center, float radius);
+    void push_back(const circle_shape& circle);
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    const float* x_data() const noexcept;
+    const float* y_data() const noexcept;
+    const float* radius_data() const noexcept;
+};
+
+// Bit i % 64 of word i / 64 is set when the circle i collides with the shape
+using hit_mask = std::vector<uint64_t>;
+
+// Instruction set the kernels were compiled with: "avx2", "sse2" or "scalar"
+const char* batch_instruction_set() noexcept;
+
+void detect(glm::vec2 point, const circle_batch& circles, hit_mask& hits);
+void detect(const circle_shape& shape, const circle_batch& circles, hit_mask& hits);
+void detect(const aabb_shape& shape, const circle_batch& circles, hit_mask& hits);
+
+// Same tests without the vector instructions, the kernels must give the same bits
+void detect_scalar(glm::vec2 point, const circle_batch& circles, hit_mask& hits);
+void detect_scalar(const circle_shape& shape, const circle_batch& circles, hit_mask& hits);
+void detect_scalar(const aabb_shape& shape, const circle_batch& circles, hit_mask& hits);
+
+// Writes the index of every set bit in increasing order, returns the number of indices
+std::size_t compact(const hit_mask& hits, std::vector<uint32_t>& indices);
+
+}
+
+#endif //MMAP_DEMO_CIRCLE_BATCH_HPP
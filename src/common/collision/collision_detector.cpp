@@ -1,18 +1,19 @@
 #include "collision_detector.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace collision {
 
 float distance(const glm::vec2& a, const glm::vec2& b) noexcept {
-    return (b - a).length();
+    return glm::length(b - a);
 }
 
 bool detect(const aabb_shape& a, const aabb_shape& b) noexcept {
     return !(a.left() > b.right()   // a trop à droite
           || a.right() < b.left()   // a trop à gauche
           || a.top() < b.bottom()   // a trop bas
-          || a.bottom() < b.top()); // a trop haut
+          || a.bottom() > b.top()); // a trop haut
 }
 
 bool detect(const aabb_shape& a, glm::vec2 b) noexcept {
@@ -36,17 +37,17 @@ bool detect(glm::vec2 a, const circle_shape& b) noexcept {
 }
 
 bool detect(const circle_shape& a, const circle_shape& b) noexcept {
-    const float dist = (b.center() - a.center()).length();
+    const float dist = distance(a.center(), b.center());
 
     return dist <= a.radius() + b.radius();
 }
 
 bool detect(const circle_shape& a, const aabb_shape& b) noexcept {
-    return detect(b, a.center())
-        || detect(a, glm::vec2{b.left(), b.top()})
-        || detect(a, glm::vec2{b.left(), b.bottom()})
-        || detect(a, glm::vec2{b.right(), b.top()})
-        || detect(a, glm::vec2{b.right(), b.bottom()});
+    // Closest point of the box to the center of the circle
+    const glm::vec2 closest(std::min(std::max(a.center().x, b.left()), b.right()),
+                            std::min(std::max(a.center().y, b.bottom()), b.top()));
+
+    return detect(a, closest);
 }
 
 bool detect(const aabb_shape& a, const circle_shape& b) noexcept {
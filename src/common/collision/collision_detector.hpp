@@ -3,6 +3,9 @@
 
 #include "aabb_shape.hpp"
 #include "circle_shape.hpp"
+#include "circle_batch.hpp"
+
+#include <iterator>
 
 namespace collision {
 
@@ -38,6 +41,23 @@ bool detect(const circle_shape& a, const circle_shape& b) noexcept;
 
 bool detect(const circle_shape& a, const aabb_shape& b) noexcept;
 bool detect(const aabb_shape& a, const circle_shape& b) noexcept;
+
+// Tests a shape against a range of circles at once, see circle_batch
+template<typename CollisionShape, typename CircleIterator>
+hit_mask detect(const CollisionShape& shape, CircleIterator first, CircleIterator last) {
+    static_assert(is_collision_shape<CollisionShape>::value, "you must specify a collision shape");
+
+    circle_batch circles;
+    circles.reserve(static_cast<std::size_t>(std::distance(first, last)));
+    for(; first != last; ++first) {
+        circles.push_back(*first);
+    }
+
+    hit_mask hits;
+    detect(shape, circles, hits);
+    return hits;
+}
+
 }
 
 #endif //MMAP_DEMO_COLLISION_DETECTOR_HPP
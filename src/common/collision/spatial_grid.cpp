@@ -0,0 +1,144 @@
+#include "spatial_grid.hpp"
+
+#include <cmath>
+
+namespace collision {
+
+spatial_grid::spatial_grid(float cell_size)
+: cell_size_(cell_size)
+, origin{0.f, 0.f} {
+
+}
+
+int spatial_grid::cell_x_of(float x) const noexcept {
+    return std::min(std::max(static_cast<int>(std::floor((x - origin.x) / cell_size_)), -1), width);
+}
+
+int spatial_grid::cell_z_of(float z) const noexcept {
+    return std::min(std::max(static_cast<int>(std::floor((z - origin.y) / cell_size_)), -1), depth);
+}
+
+spatial_grid::index_type spatial_grid::insert_sparse(cell_key key, index_type next_cell) {
+    const std::size_t mask = slot_keys.size() - 1;
+    std::size_t slot = slot_of(key);
+    while(slot_cells[slot] != NO_CELL) {
+        if(slot_keys[slot] == key) {
+            return slot_cells[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    slot_keys[slot] = key;
+    slot_cells[slot] = next_cell;
+    return next_cell;
+}
+
+void spatial_grid::build(const std::vector<glm::vec2>& positions) {
+    entries.clear();
+    entry_positions.clear();
+    cell_starts.assign(1, 0);
+    width = depth = 0;
+    is_dense = true;
+
+    if(positions.empty()) {
+        return;
+    }
+
+    glm::vec2 min_position = positions.front();
+    glm::vec2 max_position = positions.front();
+    for(glm::vec2 position : positions) {
+        min_position = glm::min(min_position, position);
+        max_position = glm::max(max_position, position);
+    }
+
+    origin = min_position;
+    width = static_cast<int>((max_position.x - min_position.x) / cell_size_) + 1;
+    depth = static_cast<int>((max_position.y - min_position.y) / cell_size_) + 1;
+
+    // Occupied cells are numbered in the order of their first point
+    point_cells.resize(positions.size());
+    index_type occupied = 0;
+    is_dense = static_cast<cell_key>(width) * static_cast<cell_key>(depth) <= DENSE_CELLS_PER_POINT * positions.size();
+    if(is_dense) {
+        dense_cells.assign(static_cast<std::size_t>(width) * depth, NO_CELL);
+        for(std::size_t i = 0; i < positions.size(); ++i) {
+            const glm::i32vec2 cell = cell_of(positions[i]);
+            index_type& dense_cell = dense_cells[key_of(cell.x, cell.y)];
+            if(dense_cell == NO_CELL) {
+                dense_cell = occupied++;
+            }
+            point_cells[i] = dense_cell;
+        }
+    }
+    else {
+        std::size_t slot_count = 2;
+        slot_shift = 63;
+        while(slot_count < positions.size() * 2) {
+            slot_count *= 2;
+            --slot_shift;
+        }
+
+        slot_keys.resize(slot_count);
+        slot_cells.assign(slot_count, NO_CELL);
+        for(std::size_t i = 0; i < positions.size(); ++i) {
+            const glm::i32vec2 cell = cell_of(positions[i]);
+            point_cells[i] = insert_sparse(key_of(cell.x, cell.y), occupied);
+            if(point_cells[i] == occupied) {
+                ++occupied;
+            }
+        }
+    }
+
+    // Counting sort of the points by occupied cell
+    cell_starts.assign(static_cast<std::size_t>(occupied) + 1, 0);
+    for(index_type cell : point_cells) {
+        ++cell_starts[cell + 1];
+    }
+
+    for(std::size_t cell = 1; cell < cell_starts.size(); ++cell) {
+        cell_starts[cell] += cell_starts[cell - 1];
+    }
+
+    entries.resize(positions.size());
+    entry_positions.resize(positions.size());
+    for(std::size_t i = 0; i < positions.size(); ++i) {
+        const index_type slot = cell_starts[point_cells[i]]++;
+        entries[slot] = static_cast<index_type>(i);
+        entry_positions[slot] = positions[i];
+    }
+
+    // Every start was moved to the end of its cell, which is the start of the next one
+    for(std::size_t cell = cell_starts.size() - 1; cell > 0; --cell) {
+        cell_starts[cell] = cell_starts[cell - 1];
+    }
+    cell_starts[0] = 0;
+}
+
+void spatial_grid::set_cell_size(float cell_size) noexcept {
+    cell_size_ = cell_size;
+}
+
+float spatial_grid::cell_size() const noexcept {
+    return cell_size_;
+}
+
+std::size_t spatial_grid::occupied_cell_count() const noexcept {
+    return cell_starts.size() - 1;
+}
+
+glm::i32vec2 spatial_grid::cell_of(glm::vec2 position) const noexcept {
+    return glm::i32vec2(std::min(std::max(cell_x_of(position.x), 0), width - 1),
+                        std::min(std::max(cell_z_of(position.y), 0), depth - 1));
+}
+
+std::size_t spatial_grid::memory_usage() const noexcept {
+    return cell_starts.capacity() * sizeof(index_type)
+         + dense_cells.capacity() * sizeof(index_type)
+         + slot_keys.capacity() * sizeof(cell_key)
+         + slot_cells.capacity() * sizeof(index_type)
+         + point_cells.capacity() * sizeof(index_type)
+         + entries.capacity() * sizeof(index_type)
+         + entry_positions.capacity() * sizeof(glm::vec2);
+}
+
+}
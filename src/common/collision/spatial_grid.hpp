@@ -0,0 +1,214 @@
+#ifndef MMAP_DEMO_SPATIAL_GRID_HPP
+#define MMAP_DEMO_SPATIAL_GRID_HPP
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace collision {
+
+// Uniform grid of points rebuilt every tick, the points of a cell are contiguous.
+// Only the occupied cells hold points so the cost follows the points, not the area they cover:
+// cells are looked up in a table of every cell when there are few cells per point, hashed otherwise
+class spatial_grid {
+public:
+    using index_type = uint32_t;
+
+    static constexpr std::size_t DENSE_CELLS_PER_POINT = 8;
+private:
+    using cell_key = uint64_t;
+
+    static constexpr index_type NO_CELL = std::numeric_limits<index_type>::max();
+
+    float cell_size_;
+    glm::vec2 origin;
+    int width = 0;
+    int depth = 0;
+    bool is_dense = true;
+
+    // Points of occupied cell c are in [cell_starts[c], cell_starts[c + 1])
+    std::vector<index_type> cell_starts;
+    std::vector<index_type> entries;
+    std::vector<glm::vec2> entry_positions;
+
+    // Occupied cell of every key when dense
+    std::vector<index_type> dense_cells;
+
+    // Open addressing table of the occupied cells when sparse, at most half full
+    std::vector<cell_key> slot_keys;
+    std::vector<index_type> slot_cells;
+    int slot_shift = 0;
+
+    // Scratch of the build
+    std::vector<index_type> point_cells;
+
+    int cell_x_of(float x) const noexcept;
+    int cell_z_of(float z) const noexcept;
+
+    cell_key key_of(int cell_x, int cell_z) const noexcept {
+        return static_cast<cell_key>(cell_z) * static_cast<cell_key>(width) + static_cast<cell_key>(cell_x);
+    }
+
+    std::size_t slot_of(cell_key key) const noexcept {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> slot_shift);
+    }
+
+    // Occupied cell of a key, a new one is numbered when the sparse table does not hold it
+    index_type insert_sparse(cell_key key, index_type next_cell);
+
+    index_type occupied_cell_at(int cell_x, int cell_z) const noexcept {
+        const cell_key key = key_of(cell_x, cell_z);
+        if(is_dense) {
+            return dense_cells[key];
+        }
+
+        const std::size_t mask = slot_keys.size() - 1;
+        for(std::size_t slot = slot_of(key); slot_cells[slot] != NO_CELL; slot = (slot + 1) & mask) {
+            if(slot_keys[slot] == key) {
+                return slot_cells[slot];
+            }
+        }
+
+        return NO_CELL;
+    }
+
+    template<typename Fn>
+    void for_each_in_cell(int cell_x, int cell_z, Fn& fn) const {
+        if(cell_x < 0 || cell_z < 0 || cell_x >= width || cell_z >= depth) {
+            return;
+        }
+
+        const index_type cell = occupied_cell_at(cell_x, cell_z);
+        if(cell != NO_CELL) {
+            for_each_in_occupied(cell, fn);
+        }
+    }
+
+public:
+    explicit spatial_grid(float cell_size);
+
+    void build(const std::vector<glm::vec2>& positions);
+
+    // Applies from the next build
+    void set_cell_size(float cell_size) noexcept;
+    float cell_size() const noexcept;
+
+    // Cells holding at least one point
+    std::size_t occupied_cell_count() const noexcept;
+
+    // Cell coordinates of a point, clamped to the grid
+    glm::i32vec2 cell_of(glm::vec2 position) const noexcept;
+
+    // Calls fn(index, position) for every point of an occupied cell, in [0, occupied_cell_count())
+    template<typename Fn>
+    void for_each_in_occupied(std::size_t cell, Fn&& fn) const {
+        for(index_type i = cell_starts[cell]; i < cell_starts[cell + 1]; ++i) {
+            fn(entries[i], entry_positions[i]);
+        }
+    }
+
+    // Calls fn(index, position) for every point within radius of center
+    template<typename Fn>
+    void for_each_in_radius(glm::vec2 center, float radius, Fn fn) const {
+        if(entries.empty()) {
+            return;
+        }
+
+        const float radius_sq = radius * radius;
+        auto visit = [&fn, center, radius_sq](index_type index, glm::vec2 position) {
+            const glm::vec2 diff = position - center;
+            if(diff.x * diff.x + diff.y * diff.y <= radius_sq) {
+                fn(index, position);
+            }
+        };
+
+        for(int z = cell_z_of(center.y - radius); z <= cell_z_of(center.y + radius); ++z) {
+            for(int x = cell_x_of(center.x - radius); x <= cell_x_of(center.x + radius); ++x) {
+                for_each_in_cell(x, z, visit);
+            }
+        }
+    }
+
+    // Writes at most K indices sorted by distance, cells are visited in rings so the search
+    // stops as soon as the remaining rings are farther than the Kth nearest point
+    template<std::size_t K, typename Predicate>
+    std::size_t k_nearest(glm::vec2 center, float radius, std::array<index_type, K>& nearest, Predicate pred) const {
+        static_assert(K > 0, "at least one neighbour must be searched");
+
+        std::array<float, K> distances_sq;
+        std::size_t found = 0;
+        if(entries.empty()) {
+            return found;
+        }
+
+        const float radius_sq = radius * radius;
+        auto visit = [&](index_type index, glm::vec2 position) {
+            const glm::vec2 diff = position - center;
+            const float distance_sq = diff.x * diff.x + diff.y * diff.y;
+            if(distance_sq > radius_sq || (found == K && distance_sq >= distances_sq[K - 1]) || !pred(index)) {
+                return;
+            }
+
+            // Insertion in the sorted list of neighbours
+            std::size_t i = found < K ? found++ : K - 1;
+            while(i > 0 && distances_sq[i - 1] > distance_sq) {
+                distances_sq[i] = distances_sq[i - 1];
+                nearest[i] = nearest[i - 1];
+                --i;
+            }
+            distances_sq[i] = distance_sq;
+            nearest[i] = index;
+        };
+
+        // Cells farther than the radius or the Kth nearest point are skipped
+        auto visit_cell = [&](int x, int z) {
+            const float dx = std::max(std::max(origin.x + x * cell_size_ - center.x, center.x - (origin.x + (x + 1) * cell_size_)), 0.f);
+            const float dz = std::max(std::max(origin.y + z * cell_size_ - center.y, center.y - (origin.y + (z + 1) * cell_size_)), 0.f);
+            const float cell_distance_sq = dx * dx + dz * dz;
+            if(cell_distance_sq <= radius_sq && (found < K || cell_distance_sq < distances_sq[K - 1])) {
+                for_each_in_cell(x, z, visit);
+            }
+        };
+
+        const int center_x = cell_x_of(center.x);
+        const int center_z = cell_z_of(center.y);
+        const int max_ring = std::max(std::max(center_x, width - 1 - center_x), std::max(center_z, depth - 1 - center_z));
+
+        for(int ring = 0; ring <= max_ring; ++ring) {
+            // Distance to the block of cells already visited, every point of this ring is at least this far
+            const float ring_distance = ring == 0 ? 0.f : std::min(std::min(center.x - (origin.x + (center_x - ring + 1) * cell_size_),
+                                                                            origin.x + (center_x + ring) * cell_size_ - center.x),
+                                                                   std::min(center.y - (origin.y + (center_z - ring + 1) * cell_size_),
+                                                                            origin.y + (center_z + ring) * cell_size_ - center.y));
+            if(ring_distance > radius || (found == K && ring_distance * ring_distance >= distances_sq[K - 1])) {
+                break;
+            }
+
+            if(ring == 0) {
+                visit_cell(center_x, center_z);
+                continue;
+            }
+
+            for(int x = center_x - ring; x <= center_x + ring; ++x) {
+                visit_cell(x, center_z - ring);
+                visit_cell(x, center_z + ring);
+            }
+
+            for(int z = center_z - ring + 1; z <= center_z + ring - 1; ++z) {
+                visit_cell(center_x - ring, z);
+                visit_cell(center_x + ring, z);
+            }
+        }
+
+        return found;
+    }
+
+    std::size_t memory_usage() const noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_SPATIAL_GRID_HPP
@@ -2,6 +2,9 @@
 #include "../actor/unit.hpp"
 #include "../world/world.hpp"
 
+#include <cassert>
+#include <iostream>
+
 namespace gameplay {
 
 base_game::base_game(std::size_t thread_count, std::unique_ptr<unit_manager> units)
@@ -19,12 +22,8 @@ void base_game::release() {
     on_release();
 }
 
-base_game::unit_flyweight_manager& base_game::unit_flyweights() {
-    return unit_flyweights_;
-}
-
-const base_game::unit_flyweight_manager& base_game::unit_flyweights() const {
-    return unit_flyweights_;
+const flyweight_table& base_game::unit_flyweights() const {
+    return units_->flyweights();
 }
 
 unit_manager& base_game::units() {
@@ -52,35 +51,56 @@ async::task_executor::task_future base_game::push_task(async::task_executor::tas
     return tasks.push(std::move(task));
 }
 
+const std::vector<glm::vec2>& base_game::separate_units() {
+    separation_positions.clear();
+    separation_radii.clear();
+    for(auto it = units_->begin_of_units(); it != units_->end_of_units(); ++it) {
+        const unit* u = it->second;
+        separation_positions.emplace_back(u->get_position().x, u->get_position().z);
+        separation_radii.push_back(collision_radius(units_->stats_of(*u)));
+    }
+
+    return separation.solve(separation_positions, separation_radii, [this](async::task_executor::task_ptr task) {
+        return push_task(std::move(task));
+    });
+}
+
+bool base_game::has_flyweight(int flyweight_id) const noexcept {
+    return units_->flyweights().index_of(flyweight_id) != flyweight_table::INVALID_INDEX;
+}
+
 target_handle base_game::add_unit(uint32_t id, glm::vec3 position, glm::vec2 target, int flyweight_id) {
+    if(!has_flyweight(flyweight_id)) {
+        std::cerr << "unit " << id << " has unknown flyweight " << flyweight_id << std::endl;
+        return target_handle();
+    }
+
     return units_->add(make_unit(position, target, flyweight_id), id);
 }
 
 target_handle base_game::add_unit(uint32_t id, glm::vec3 position, int flyweight_id) {
-	return units_->add(make_unit(position, flyweight_id), id);
+	return add_unit(id, position, glm::vec2(position.x, position.z), flyweight_id);
 }
 
 
 unit base_game::make_unit(glm::vec3 position, glm::vec2 target, int flyweight_id) {
-    return unit(position, target, &unit_flyweights_[flyweight_id], units_.get());
+    assert(has_flyweight(flyweight_id));
+    const flyweight_table& flyweights = units_->flyweights();
+    return unit(position, target, flyweights, flyweights.index_of(flyweight_id), units_.get());
 }
 
 unit base_game::make_unit(glm::vec3 position, int flyweight_id) {
-	return unit(position, position, &unit_flyweights_[flyweight_id], units_.get());
+	return make_unit(position, glm::vec2(position.x, position.z), flyweight_id);
 }
 
 void base_game::load_flyweight(const nlohmann::json& json) {
-    int id = json["id"];
-
-    unit_flyweights_[id] = unit_flyweight(json);
+    units_->flyweights().add(unit_flyweight(json));
 }
 
-void base_game::set_flyweight_manager(const unit_flyweight_manager& manager)
-{
-    unit_flyweights_ = manager;
-}
-void base_game::set_flyweight_manager(unit_flyweight_manager&& manager)
-{
-    unit_flyweights_ = manager;
+void base_game::set_flyweights(const std::vector<unit_flyweight>& flyweights) {
+    units_->flyweights().clear();
+    for(const unit_flyweight& flyweight : flyweights) {
+        units_->flyweights().add(flyweight);
+    }
 }
 }
\ No newline at end of file
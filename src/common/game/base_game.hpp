@@ -2,13 +2,15 @@
 #define MMAP_DEMO_BASE_GAME_HPP
 
 #include "../actor/unit_flyweight.hpp"
+#include "../actor/flyweight_table.hpp"
+#include "separation_system.hpp"
 #include "../async/task_executor.hpp"
 #include "../actor/unit_manager.hpp"
 #include "../time/clock.hpp"
 #include "../world/world.hpp"
 
 #include <chrono>
-#include <unordered_map>
+#include <vector>
 
 namespace gameplay {
 
@@ -16,14 +18,17 @@ class base_game {
 public:
     using clock = std::chrono::high_resolution_clock;
     using frame_duration = clock::duration;
-    using unit_flyweight_manager = std::unordered_map<int, unit_flyweight>;
 private:
     // Thread pool
     async::task_executor tasks;
 
     // Units
     std::unique_ptr<unit_manager> units_;
-    unit_flyweight_manager unit_flyweights_;
+
+    // Local avoidance
+    separation_system separation;
+    std::vector<glm::vec2> separation_positions;
+    std::vector<float> separation_radii;
 
     // Game loop management
     bool will_loop;
@@ -40,8 +45,7 @@ public:
     void init();
     void release();
 
-    unit_flyweight_manager& unit_flyweights();
-    const unit_flyweight_manager& unit_flyweights() const;
+    const flyweight_table& unit_flyweights() const;
 
     unit_manager& units();
     const unit_manager& units() const;
@@ -53,15 +57,23 @@ public:
     void stop() noexcept;
 
     async::task_executor::task_future push_task(async::task_executor::task_ptr task);
+
+    // Push of every unit, in the order of the units, to apart those that overlap. Solved in parallel
+    // from the positions before the movement task, which applies them with the step of each unit
+    const std::vector<glm::vec2>& separate_units();
+    bool has_flyweight(int flyweight_id) const noexcept;
+
+    // Units of an unknown flyweight are rejected, the handle is then empty
     target_handle add_unit(uint32_t id, glm::vec3 position, glm::vec2 target, int flyweight_id); 
 	 target_handle add_unit(uint32_t id, glm::vec3 position, int flyweight_id);
+    // The flyweight must be known
     unit make_unit(glm::vec3 position, glm::vec2 target, int flyweight_id); // TODO: Make const
     unit make_unit(glm::vec3 position, int flyweight_id); // TODO: Make const
 
     void load_flyweight(const nlohmann::json& json);
 
-    void set_flyweight_manager(const unit_flyweight_manager& manager);
-    void set_flyweight_manager(unit_flyweight_manager&& manager);
+    // The dense indices follow the order of the flyweights, the server sends them in this order
+    void set_flyweights(const std::vector<unit_flyweight>& flyweights);
 };
 
 }
@@ -0,0 +1,64 @@
+#include "combat_system.hpp"
+
+#include <array>
+
+namespace gameplay {
+
+combat_system::combat_system(float cell_size)
+: grid(cell_size) {
+
+}
+
+void combat_system::attack(std::vector<combatant>& fighters, std::size_t first, std::size_t last, float elapsed_seconds, std::vector<hit>& hits) {
+    std::array<collision::spatial_grid::index_type, 1> nearest;
+    hits.clear();
+
+    for(std::size_t i = first; i < last; ++i) {
+        combatant& attacker = fighters[i];
+        attacker.cooldown = std::max(0.f, attacker.cooldown - elapsed_seconds);
+        if(attacker.cooldown > 0.f || attacker.stats->damage == 0) {
+            continue;
+        }
+
+        const uint8_t owner = attacker.owner;
+        const std::size_t found = grid.k_nearest(attacker.position, attacker.stats->range, nearest, [&fighters, owner](uint32_t other) {
+            return fighters[other].owner != owner;
+        });
+
+        // The health of the defender is only read by other batches, the damage lands after every batch
+        if(found > 0) {
+            const combatant& defender = fighters[nearest[0]];
+            hits.push_back(hit{nearest[0], std::max(1, attacker.stats->damage - defender.stats->armor)});
+            attacker.cooldown = attacker.stats->attack_speed > 0.f ? 1.f / attacker.stats->attack_speed : 0.f;
+        }
+    }
+}
+
+void combat_system::apply_hits(std::vector<combatant>& fighters) const {
+    const std::size_t batch_count = (fighters.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+    for(std::size_t batch = 0; batch < batch_count; ++batch) {
+        for(const hit& h : batch_hits[batch]) {
+            fighters[h.target].health -= h.damage;
+        }
+    }
+}
+
+void combat_system::remove_dead(std::vector<combatant>& fighters) {
+    killed_.clear();
+
+    auto alive_end = std::remove_if(std::begin(fighters), std::end(fighters), [this](const combatant& f) {
+        if(f.health <= 0) {
+            killed_.push_back(f.id);
+            return true;
+        }
+
+        return false;
+    });
+    fighters.erase(alive_end, std::end(fighters));
+}
+
+const std::vector<uint32_t>& combat_system::killed() const noexcept {
+    return killed_;
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef MMAP_DEMO_COMBAT_SYSTEM_HPP
+#define MMAP_DEMO_COMBAT_SYSTEM_HPP
+
+#include "../actor/flyweight_table.hpp"
+#include "../async/task_executor.hpp"
+#include "../collision/spatial_grid.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace gameplay {
+
+struct combatant {
+    uint32_t id;
+    uint8_t owner;
+    glm::vec2 position;
+    const unit_stats* stats;
+    int health;
+
+    // Seconds before the next attack
+    float cooldown;
+};
+
+// Every fighter attacks its nearest hostile in range, all the attacks of a tick land at once
+class combat_system {
+public:
+    static constexpr std::size_t BATCH_SIZE = 1024;
+private:
+    struct hit {
+        uint32_t target;
+        int damage;
+    };
+
+    collision::spatial_grid grid;
+    std::vector<glm::vec2> positions;
+
+    // Damage dealt by each batch, only merged once every batch is done
+    std::vector<std::vector<hit>> batch_hits;
+    std::vector<uint32_t> killed_;
+
+    void attack(std::vector<combatant>& fighters, std::size_t first, std::size_t last, float elapsed_seconds, std::vector<hit>& hits);
+    void apply_hits(std::vector<combatant>& fighters) const;
+    void remove_dead(std::vector<combatant>& fighters);
+
+public:
+    explicit combat_system(float cell_size = 4.f);
+
+    // Targets are acquired and damage computed in parallel batches, push must forward the tasks to an executor
+    template<typename TaskPusher>
+    void update(std::vector<combatant>& fighters, float elapsed_seconds, TaskPusher push) {
+        positions.resize(fighters.size());
+        std::transform(std::begin(fighters), std::end(fighters), std::begin(positions), [](const combatant& f) {
+            return f.position;
+        });
+        grid.build(positions);
+
+        const std::size_t batch_count = (fighters.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+        if(batch_hits.size() < batch_count) {
+            batch_hits.resize(batch_count);
+        }
+
+        std::vector<async::task_executor::task_future> batches;
+        for(std::size_t batch = 0; batch < batch_count; ++batch) {
+            const std::size_t first = batch * BATCH_SIZE;
+            const std::size_t last = std::min(first + BATCH_SIZE, fighters.size());
+            std::vector<hit>& hits = batch_hits[batch];
+            batches.push_back(push(async::make_task([this, &fighters, first, last, elapsed_seconds, &hits]() {
+                attack(fighters, first, last, elapsed_seconds, hits);
+            })));
+        }
+
+        for(auto& batch : batches) {
+            batch.wait();
+        }
+
+        apply_hits(fighters);
+        remove_dead(fighters);
+    }
+
+    // Ids of the fighters removed by the last update
+    const std::vector<uint32_t>& killed() const noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_COMBAT_SYSTEM_HPP
@@ -0,0 +1,62 @@
+#include "separation_system.hpp"
+
+#include <cmath>
+
+namespace gameplay {
+
+namespace {
+
+// Agents at the exact same position are split along a direction that only depends on the pair
+glm::vec2 tie_breaking_direction(uint32_t agent, uint32_t other) noexcept {
+    const uint32_t hash = std::min(agent, other) * 2654435761u ^ std::max(agent, other);
+    const float angle = (hash % 6283u) / 1000.f;
+    const float side = agent < other ? -1.f : 1.f;
+
+    return glm::vec2(std::cos(angle) * side, std::sin(angle) * side);
+}
+
+}
+
+separation_system::separation_system()
+: grid(1.f) {
+
+}
+
+void separation_system::separate_cells(const std::vector<float>& radii, std::size_t first_cell, std::size_t last_cell) {
+    for(std::size_t cell = first_cell; cell < last_cell; ++cell) {
+        grid.for_each_in_occupied(cell, [&](uint32_t agent, glm::vec2 position) {
+            const float radius = radii[agent];
+            glm::vec2 push{0.f, 0.f};
+
+            grid.for_each_in_radius(position, radius + max_radius, [&](uint32_t other, glm::vec2 other_position) {
+                if(other == agent) {
+                    return;
+                }
+
+                const glm::vec2 diff = position - other_position;
+                const float distance = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+                const float overlap = radius + radii[other] - distance;
+                if(overlap <= 0.f) {
+                    return;
+                }
+
+                const glm::vec2 direction = distance > 1e-6f ? diff / distance : tie_breaking_direction(agent, other);
+                push += direction * (overlap * 0.5f);
+            });
+
+            // A crowded agent never jumps farther than its own radius in a step
+            const float length = std::sqrt(push.x * push.x + push.y * push.y);
+            if(length > radius) {
+                push *= radius / length;
+            }
+
+            displacements_[agent] = push;
+        });
+    }
+}
+
+const std::vector<glm::vec2>& separation_system::displacements() const noexcept {
+    return displacements_;
+}
+
+}
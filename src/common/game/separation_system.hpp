@@ -0,0 +1,61 @@
+#ifndef MMAP_DEMO_SEPARATION_SYSTEM_HPP
+#define MMAP_DEMO_SEPARATION_SYSTEM_HPP
+
+#include "../async/task_executor.hpp"
+#include "../collision/spatial_grid.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace gameplay {
+
+// Pushes apart the circles that overlap, every agent moves by half of each overlap.
+// Displacements only depend on the positions before the step so cells are solved in parallel
+class separation_system {
+public:
+    static const std::size_t CELLS_PER_BATCH = 256;
+private:
+    collision::spatial_grid grid;
+    std::vector<glm::vec2> displacements_;
+    float max_radius = 0.f;
+
+    void separate_cells(const std::vector<float>& radii, std::size_t first_cell, std::size_t last_cell);
+
+public:
+    separation_system();
+
+    // Returns the displacement of every agent, push must forward the tasks to an executor
+    template<typename TaskPusher>
+    const std::vector<glm::vec2>& solve(const std::vector<glm::vec2>& positions, const std::vector<float>& radii, TaskPusher push) {
+        displacements_.assign(positions.size(), glm::vec2{0.f, 0.f});
+        max_radius = radii.empty() ? 0.f : *std::max_element(std::begin(radii), std::end(radii));
+
+        // Two agents overlap only when they are in the same or in adjacent cells
+        if(max_radius > 0.f) {
+            grid.set_cell_size(2.f * max_radius);
+        }
+        grid.build(positions);
+
+        std::vector<async::task_executor::task_future> batches;
+        const std::size_t cells = grid.occupied_cell_count();
+        for(std::size_t first_cell = 0; first_cell < cells; first_cell += CELLS_PER_BATCH) {
+            const std::size_t last_cell = std::min(first_cell + CELLS_PER_BATCH, cells);
+            batches.push_back(push(async::make_task([this, &radii, first_cell, last_cell]() {
+                separate_cells(radii, first_cell, last_cell);
+            })));
+        }
+
+        for(auto& batch : batches) {
+            batch.wait();
+        }
+
+        return displacements_;
+    }
+
+    const std::vector<glm::vec2>& displacements() const noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_SEPARATION_SYSTEM_HPP
@@ -0,0 +1,143 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory {
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+: bytes{std::exchange(other.bytes, nullptr)}
+, length{std::exchange(other.length, 0)}
+#ifdef WIN32
+, file_handle{std::exchange(other.file_handle, nullptr)}
+, mapping_handle{std::exchange(other.mapping_handle, nullptr)}
+#endif
+{
+
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+    if(this != &other) {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef WIN32
+        file_handle = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+#ifdef WIN32
+bool mapped_file::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    file_handle = file;
+    mapping_handle = mapping;
+
+    return true;
+}
+
+void mapped_file::close() noexcept {
+    if(bytes) {
+        UnmapViewOfFile(bytes);
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+    }
+
+    bytes = nullptr;
+    length = 0;
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+}
+#else
+bool mapped_file::open(const std::string& path) {
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0 || status.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+
+    // The mapping keeps the file alive once its descriptor is closed
+    void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if(view == MAP_FAILED) {
+        return false;
+    }
+
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<std::size_t>(status.st_size);
+
+    return true;
+}
+
+void mapped_file::close() noexcept {
+    if(bytes) {
+        munmap(const_cast<uint8_t*>(bytes), length);
+    }
+
+    bytes = nullptr;
+    length = 0;
+}
+#endif
+
+bool mapped_file::is_open() const noexcept {
+    return bytes != nullptr;
+}
+
+const uint8_t* mapped_file::data() const noexcept {
+    return bytes;
+}
+
+std::size_t mapped_file::size() const noexcept {
+    return length;
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef MMAP_DEMO_MAPPED_FILE_HPP
+#define MMAP_DEMO_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace memory {
+
+// Read only view of a whole file, the system loads its pages on first access
+class mapped_file {
+    const uint8_t* bytes = nullptr;
+    std::size_t length = 0;
+#ifdef WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+    ~mapped_file();
+
+    // Returns false when the file is missing, empty or can not be mapped
+    bool open(const std::string& path);
+    void close() noexcept;
+
+    bool is_open() const noexcept;
+    const uint8_t* data() const noexcept;
+    std::size_t size() const noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_MAPPED_FILE_HPP
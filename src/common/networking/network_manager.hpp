@@ -184,6 +184,15 @@ public:
     std::pair<bool, packet> poll_packet_from(int packet_type, socket_handle src);
     std::vector<std::pair<socket_handle, packet>> poll_packets();
 
+    // Returns true as soon as a packet is waiting to be polled, false once the deadline is reached
+    template<typename TimePoint>
+    bool wait_packets_until(TimePoint deadline) {
+        std::unique_lock<std::mutex> lock(received_lock);
+        return received_request_cv.wait_until(lock, deadline, [this]() {
+            return !received_requests.empty();
+        });
+    }
+
     template<typename TimeoutDuration>
     std::pair<bool, packet> wait_packet_from_for(int packet_type, socket_handle src, TimeoutDuration duration) {
         std::unique_lock<std::mutex> lock(received_lock);
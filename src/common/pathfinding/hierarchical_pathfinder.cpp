@@ -0,0 +1,414 @@
+#include "hierarchical_pathfinder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <queue>
+
+namespace pathfinding {
+
+namespace {
+
+const int CHUNK_WIDTH = static_cast<int>(world::CHUNK_WIDTH);
+const int CHUNK_DEPTH = static_cast<int>(world::CHUNK_DEPTH);
+
+int floor_div(int value, int divisor) noexcept {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+int local_index(glm::i32vec2 local) noexcept {
+    return local.y * CHUNK_WIDTH + local.x;
+}
+
+glm::i32vec2 local_position(int index) noexcept {
+    return glm::i32vec2(index % CHUNK_WIDTH, index / CHUNK_WIDTH);
+}
+
+uint32_t octile_distance(glm::i32vec2 a, glm::i32vec2 b) noexcept {
+    const uint32_t dx = static_cast<uint32_t>(std::abs(a.x - b.x));
+    const uint32_t dy = static_cast<uint32_t>(std::abs(a.y - b.y));
+
+    return hierarchical_pathfinder::STRAIGHT_COST * std::max(dx, dy)
+         + (hierarchical_pathfinder::DIAGONAL_COST - hierarchical_pathfinder::STRAIGHT_COST) * std::min(dx, dy);
+}
+
+template<typename Node>
+struct open_node {
+    uint32_t priority;
+    Node node;
+
+    bool operator>(const open_node& other) const noexcept {
+        return priority > other.priority;
+    }
+};
+
+// Only keeps the tiles where the direction changes
+void append_compressed(const std::vector<glm::i32vec2>& tiles, glm::i32vec2 start, std::deque<glm::i32vec2>& waypoints) {
+    glm::i32vec2 previous = start;
+    for(std::size_t i = 0; i < tiles.size(); ++i) {
+        if(i + 1 == tiles.size() || tiles[i] - previous != tiles[i + 1] - tiles[i]) {
+            waypoints.push_back(tiles[i]);
+        }
+        previous = tiles[i];
+    }
+}
+
+}
+
+hierarchical_pathfinder::hierarchical_pathfinder(const world& w)
+: w(w) {
+
+}
+
+world_chunk::position_type hierarchical_pathfinder::chunk_of(tile_position tile) noexcept {
+    return world_chunk::position_type(floor_div(tile.x, CHUNK_WIDTH), floor_div(tile.y, CHUNK_DEPTH));
+}
+
+hierarchical_pathfinder::tile_position hierarchical_pathfinder::to_chunk_space(tile_position tile) noexcept {
+    const world_chunk::position_type chunk = chunk_of(tile);
+    return tile_position(tile.x - chunk.x * CHUNK_WIDTH, tile.y - chunk.y * CHUNK_DEPTH);
+}
+
+hierarchical_pathfinder::tile_position hierarchical_pathfinder::to_world_space(world_chunk::position_type chunk, tile_position local) noexcept {
+    return tile_position(chunk.x * CHUNK_WIDTH + local.x, chunk.y * CHUNK_DEPTH + local.y);
+}
+
+bool hierarchical_pathfinder::is_walkable(movement_class movement, tile_position tile) const noexcept {
+    return w.is_walkable(movement, tile.x, tile.y);
+}
+
+hierarchical_pathfinder::chunk_walkability hierarchical_pathfinder::walkability_of(movement_class movement, world_chunk::position_type chunk_pos) const noexcept {
+    chunk_walkability walkable;
+
+    for(int z = 0; z < CHUNK_DEPTH; ++z) {
+        for(int x = 0; x < CHUNK_WIDTH; ++x) {
+            walkable[local_index({x, z})] = is_walkable(movement, to_world_space(chunk_pos, {x, z}));
+        }
+    }
+
+    return walkable;
+}
+
+void hierarchical_pathfinder::flood(const chunk_walkability& walkable, tile_position source, chunk_costs& costs, chunk_parents* parents) const {
+    static const std::array<glm::i32vec2, 8> DIRECTIONS = {{
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1},
+        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
+    }};
+
+    costs.fill(UNREACHABLE);
+    if(parents) {
+        parents->fill(-1);
+    }
+
+    const int source_index = local_index(source);
+    if(!walkable[source_index]) {
+        return;
+    }
+
+    std::priority_queue<open_node<int>, std::vector<open_node<int>>, std::greater<open_node<int>>> open;
+    costs[source_index] = 0;
+    open.push({0, source_index});
+
+    while(!open.empty()) {
+        const open_node<int> current = open.top();
+        open.pop();
+
+        if(current.priority > costs[current.node]) {
+            continue;
+        }
+
+        const glm::i32vec2 tile = local_position(current.node);
+        for(const glm::i32vec2& direction : DIRECTIONS) {
+            const glm::i32vec2 next = tile + direction;
+            if(next.x < 0 || next.y < 0 || next.x >= CHUNK_WIDTH || next.y >= CHUNK_DEPTH) {
+                continue;
+            }
+
+            const int next_index = local_index(next);
+            if(!walkable[next_index]) {
+                continue;
+            }
+
+            const bool is_diagonal = direction.x != 0 && direction.y != 0;
+
+            // Units cannot cut corners
+            if(is_diagonal && (!walkable[local_index({tile.x + direction.x, tile.y})] || !walkable[local_index({tile.x, tile.y + direction.y})])) {
+                continue;
+            }
+
+            const uint32_t next_cost = current.priority + (is_diagonal ? DIAGONAL_COST : STRAIGHT_COST);
+            if(next_cost < costs[next_index]) {
+                costs[next_index] = static_cast<cost_type>(next_cost);
+                if(parents) {
+                    (*parents)[next_index] = static_cast<int16_t>(current.node);
+                }
+                open.push({next_cost, next_index});
+            }
+        }
+    }
+}
+
+void hierarchical_pathfinder::build_graph(movement_class movement, world_chunk::position_type chunk, chunk_graph& graph) const {
+    graph.portals.clear();
+    graph.twins.clear();
+    graph.costs.clear();
+    graph.is_dirty = false;
+
+    if(!w.chunk_at(chunk.x, chunk.y)) {
+        return;
+    }
+
+    const chunk_walkability walkable = walkability_of(movement, chunk);
+
+    // Every side of the chunk: first border tile, step along the border and the offset to cross it
+    struct border {
+        tile_position start;
+        tile_position step;
+        tile_position outside;
+        int length;
+    };
+
+    const std::array<border, 4> borders = {{
+        {{0, 0},               {0, 1}, {-1, 0}, CHUNK_DEPTH},
+        {{CHUNK_WIDTH - 1, 0}, {0, 1}, { 1, 0}, CHUNK_DEPTH},
+        {{0, 0},               {1, 0}, {0, -1}, CHUNK_WIDTH},
+        {{0, CHUNK_DEPTH - 1}, {1, 0}, {0,  1}, CHUNK_WIDTH}
+    }};
+
+    for(const border& side : borders) {
+        int run_start = -1;
+        for(int i = 0; i <= side.length; ++i) {
+            const tile_position local = side.start + side.step * i;
+
+            bool is_open = false;
+            if(i < side.length) {
+                is_open = walkable[local_index(local)] && is_walkable(movement, to_world_space(chunk, local) + side.outside);
+            }
+
+            if(is_open && run_start < 0) {
+                run_start = i;
+            }
+            else if(!is_open && run_start >= 0) {
+                // A single portal in the middle of each opening
+                const tile_position portal = side.start + side.step * ((run_start + i - 1) / 2);
+                graph.portals.push_back(portal);
+                graph.twins.push_back(to_world_space(chunk, portal) + side.outside);
+                run_start = -1;
+            }
+        }
+    }
+
+    const std::size_t portal_count = graph.portals.size();
+    graph.costs.resize(portal_count * portal_count, UNREACHABLE);
+
+    chunk_costs costs;
+    for(std::size_t i = 0; i < portal_count; ++i) {
+        flood(walkable, graph.portals[i], costs, nullptr);
+
+        for(std::size_t j = 0; j < portal_count; ++j) {
+            graph.costs[i * portal_count + j] = costs[local_index(graph.portals[j])];
+        }
+    }
+}
+
+const hierarchical_pathfinder::chunk_graph& hierarchical_pathfinder::graph_of(movement_class movement, world_chunk::position_type chunk) {
+    chunk_graph& graph = graphs[movement][chunk];
+    if(graph.is_dirty) {
+        build_graph(movement, chunk, graph);
+    }
+
+    return graph;
+}
+
+void hierarchical_pathfinder::build(movement_class movement) {
+    std::for_each(std::begin(w), std::end(w), [this, movement](const world_chunk& chunk) {
+        graph_of(movement, chunk.position());
+    });
+}
+
+void hierarchical_pathfinder::invalidate(int chunk_x, int chunk_z) {
+    static const std::array<world_chunk::position_type, 5> AFFECTED = {{
+        {0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}
+    }};
+
+    // The portals of the neighbours depend on this chunk's border
+    for(auto& pair : graphs) {
+        for(const world_chunk::position_type& offset : AFFECTED) {
+            auto it = pair.second.find(world_chunk::position_type(chunk_x, chunk_z) + offset);
+            if(it != std::end(pair.second)) {
+                it->second.is_dirty = true;
+            }
+        }
+    }
+}
+
+path hierarchical_pathfinder::find_path(movement_class movement, tile_position from, tile_position to) {
+    path found_path;
+    found_path.movement = movement;
+    found_path.refined_until = from;
+
+    if(!is_walkable(movement, from) || !is_walkable(movement, to)) {
+        return found_path;
+    }
+
+    const world_chunk::position_type from_chunk = chunk_of(from);
+    const world_chunk::position_type to_chunk = chunk_of(to);
+
+    if(from == to) {
+        found_path.abstract_waypoints.push_back(to);
+        return found_path;
+    }
+
+    chunk_costs from_costs;
+    flood(walkability_of(movement, from_chunk), to_chunk_space(from), from_costs, nullptr);
+
+    chunk_costs to_costs;
+    flood(walkability_of(movement, to_chunk), to_chunk_space(to), to_costs, nullptr);
+
+    // The goal is linked to the portals of its chunk
+    const chunk_graph& goal_graph = graph_of(movement, to_chunk);
+    std::unordered_map<tile_position, uint32_t, util::vec2_hash<tile_position>> goal_links;
+    for(const tile_position& portal : goal_graph.portals) {
+        const cost_type cost = to_costs[local_index(portal)];
+        if(cost != UNREACHABLE) {
+            goal_links[to_world_space(to_chunk, portal)] = cost;
+        }
+    }
+
+    using node_queue = std::priority_queue<open_node<tile_position>, std::vector<open_node<tile_position>>, std::greater<open_node<tile_position>>>;
+    node_queue open;
+    std::unordered_map<tile_position, uint32_t, util::vec2_hash<tile_position>> best_costs;
+    std::unordered_map<tile_position, tile_position, util::vec2_hash<tile_position>> parents;
+
+    auto relax = [&](tile_position node, tile_position parent, uint32_t cost) {
+        auto it = best_costs.find(node);
+        if(it == std::end(best_costs) || cost < it->second) {
+            best_costs[node] = cost;
+            parents[node] = parent;
+            open.push({cost + octile_distance(node, to), node});
+        }
+    };
+
+    // Seeds the search with the portals reachable from the start
+    if(from_chunk == to_chunk && from_costs[local_index(to_chunk_space(to))] != UNREACHABLE) {
+        relax(to, from, from_costs[local_index(to_chunk_space(to))]);
+    }
+
+    const chunk_graph& start_graph = graph_of(movement, from_chunk);
+    for(const tile_position& portal : start_graph.portals) {
+        const cost_type cost = from_costs[local_index(portal)];
+        if(cost != UNREACHABLE) {
+            relax(to_world_space(from_chunk, portal), from, cost);
+        }
+    }
+
+    bool is_found = false;
+    while(!open.empty()) {
+        const open_node<tile_position> current = open.top();
+        open.pop();
+
+        const uint32_t current_cost = best_costs[current.node];
+        if(current.priority > current_cost + octile_distance(current.node, to)) {
+            continue;
+        }
+
+        if(current.node == to) {
+            is_found = true;
+            break;
+        }
+
+        auto goal_it = goal_links.find(current.node);
+        if(goal_it != std::end(goal_links)) {
+            relax(to, current.node, current_cost + goal_it->second);
+        }
+
+        const world_chunk::position_type chunk = chunk_of(current.node);
+        const tile_position local = to_chunk_space(current.node);
+        const chunk_graph& graph = graph_of(movement, chunk);
+        const std::size_t portal_count = graph.portals.size();
+
+        for(std::size_t i = 0; i < portal_count; ++i) {
+            if(graph.portals[i] != local) {
+                continue;
+            }
+
+            relax(graph.twins[i], current.node, current_cost + STRAIGHT_COST);
+
+            for(std::size_t j = 0; j < portal_count; ++j) {
+                const cost_type cost = graph.costs[i * portal_count + j];
+                if(i != j && cost != UNREACHABLE) {
+                    relax(to_world_space(chunk, graph.portals[j]), current.node, current_cost + cost);
+                }
+            }
+        }
+    }
+
+    if(is_found) {
+        for(tile_position node = to; node != from; node = parents[node]) {
+            found_path.abstract_waypoints.push_back(node);
+        }
+        std::reverse(std::begin(found_path.abstract_waypoints), std::end(found_path.abstract_waypoints));
+    }
+
+    return found_path;
+}
+
+bool hierarchical_pathfinder::refine(path& p) {
+    if(p.is_refined()) {
+        return false;
+    }
+
+    const tile_position start = p.refined_until;
+    const tile_position target = p.abstract_waypoints[p.next_abstract_waypoint];
+    const world_chunk::position_type chunk = chunk_of(start);
+
+    std::vector<tile_position> tiles;
+    if(chunk_of(target) != chunk) {
+        // Crossing a portal
+        tiles.push_back(target);
+    }
+    else {
+        chunk_costs costs;
+        chunk_parents parents;
+        flood(walkability_of(p.movement, chunk), to_chunk_space(start), costs, &parents);
+
+        int index = local_index(to_chunk_space(target));
+        if(costs[index] == UNREACHABLE) {
+            // The world changed since the path was found
+            p.next_abstract_waypoint = p.abstract_waypoints.size();
+            return false;
+        }
+
+        for(; parents[index] >= 0; index = parents[index]) {
+            tiles.push_back(to_world_space(chunk, local_position(index)));
+        }
+        std::reverse(std::begin(tiles), std::end(tiles));
+    }
+
+    append_compressed(tiles, start, p.waypoints);
+
+    p.refined_until = target;
+    ++p.next_abstract_waypoint;
+
+    return true;
+}
+
+std::size_t hierarchical_pathfinder::memory_usage() const noexcept {
+    std::size_t usage = sizeof(*this);
+
+    for(const auto& pair : graphs) {
+        usage += sizeof(pair) + pair.second.bucket_count() * sizeof(void*);
+
+        for(const auto& graph : pair.second) {
+            usage += sizeof(graph)
+                   + graph.second.portals.capacity() * sizeof(tile_position)
+                   + graph.second.twins.capacity() * sizeof(tile_position)
+                   + graph.second.costs.capacity() * sizeof(cost_type);
+        }
+    }
+
+    return usage;
+}
+
+}
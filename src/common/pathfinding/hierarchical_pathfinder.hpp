@@ -0,0 +1,85 @@
+#ifndef MMAP_DEMO_HIERARCHICAL_PATHFINDER_HPP
+#define MMAP_DEMO_HIERARCHICAL_PATHFINDER_HPP
+
+#include "path.hpp"
+#include "../world/world.hpp"
+#include "../world/movement_class.hpp"
+#include "../util/vec_hash.hpp"
+
+#include <glm/glm.hpp>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace pathfinding {
+
+// HPA*: each chunk is abstracted by the openings (portals) on its borders and the precomputed
+// cost between each pair of them. Queries search this abstract graph, the tile path is only
+// refined chunk by chunk while a unit walks it.
+class hierarchical_pathfinder {
+public:
+    using tile_position = glm::i32vec2;
+    using cost_type = uint16_t;
+
+    static constexpr cost_type UNREACHABLE = std::numeric_limits<cost_type>::max();
+    static constexpr cost_type STRAIGHT_COST = 10;
+    static constexpr cost_type DIAGONAL_COST = 14;
+private:
+    static constexpr std::size_t CHUNK_TILE_COUNT = world::CHUNK_WIDTH * world::CHUNK_DEPTH;
+
+    using chunk_walkability = std::bitset<CHUNK_TILE_COUNT>;
+    using chunk_costs = std::array<cost_type, CHUNK_TILE_COUNT>;
+    using chunk_parents = std::array<int16_t, CHUNK_TILE_COUNT>;
+
+    struct chunk_graph {
+        // Border tiles, in chunk space
+        std::vector<tile_position> portals;
+
+        // The tile on the other side of each portal, in world space
+        std::vector<tile_position> twins;
+
+        // Cost from portal i to portal j is at i * portals.size() + j
+        std::vector<cost_type> costs;
+
+        bool is_dirty = true;
+    };
+
+    using chunk_graph_collection = std::unordered_map<world_chunk::position_type, chunk_graph, util::vec2_hash<world_chunk::position_type>>;
+
+    const world& w;
+    std::unordered_map<movement_class, chunk_graph_collection> graphs;
+
+    static world_chunk::position_type chunk_of(tile_position tile) noexcept;
+    static tile_position to_chunk_space(tile_position tile) noexcept;
+    static tile_position to_world_space(world_chunk::position_type chunk, tile_position local) noexcept;
+
+    bool is_walkable(movement_class movement, tile_position tile) const noexcept;
+    chunk_walkability walkability_of(movement_class movement, world_chunk::position_type chunk) const noexcept;
+
+    void flood(const chunk_walkability& walkable, tile_position source, chunk_costs& costs, chunk_parents* parents) const;
+    void build_graph(movement_class movement, world_chunk::position_type chunk, chunk_graph& graph) const;
+    const chunk_graph& graph_of(movement_class movement, world_chunk::position_type chunk);
+
+public:
+    explicit hierarchical_pathfinder(const world& w);
+
+    // Precomputes the abstract graph of every loaded chunk for this movement class
+    void build(movement_class movement);
+
+    // Must be called when the biomes of a chunk have changed
+    void invalidate(int chunk_x, int chunk_z);
+
+    path find_path(movement_class movement, tile_position from, tile_position to);
+
+    // Refines the next abstract segment of the path into tile waypoints
+    bool refine(path& p);
+
+    std::size_t memory_usage() const noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_HIERARCHICAL_PATHFINDER_HPP
@@ -0,0 +1,37 @@
+#include "path.hpp"
+
+namespace pathfinding {
+
+bool path::found() const noexcept {
+    return !abstract_waypoints.empty();
+}
+
+bool path::is_refined() const noexcept {
+    return next_abstract_waypoint >= abstract_waypoints.size();
+}
+
+bool path::is_completed() const noexcept {
+    return is_refined() && waypoints.empty();
+}
+
+movement_class path::movement_type() const noexcept {
+    return movement;
+}
+
+glm::i32vec2 path::goal() const noexcept {
+    return abstract_waypoints.back();
+}
+
+bool path::has_waypoint() const noexcept {
+    return !waypoints.empty();
+}
+
+glm::i32vec2 path::next_waypoint() const noexcept {
+    return waypoints.front();
+}
+
+void path::pop_waypoint() noexcept {
+    waypoints.pop_front();
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef MMAP_DEMO_PATH_HPP
+#define MMAP_DEMO_PATH_HPP
+
+#include "../world/movement_class.hpp"
+
+#include <glm/glm.hpp>
+#include <deque>
+#include <vector>
+
+namespace pathfinding {
+
+class hierarchical_pathfinder;
+
+// A path found at the chunk level, refined into tile waypoints only when needed
+class path {
+    friend hierarchical_pathfinder;
+
+    movement_class movement = 0;
+
+    // Portals to cross, ending with the goal tile
+    std::vector<glm::i32vec2> abstract_waypoints;
+    std::size_t next_abstract_waypoint = 0;
+
+    // Last tile reached by the refinement
+    glm::i32vec2 refined_until;
+    std::deque<glm::i32vec2> waypoints;
+
+public:
+    path() = default;
+
+    bool found() const noexcept;
+    bool is_refined() const noexcept;
+    bool is_completed() const noexcept;
+
+    movement_class movement_type() const noexcept;
+    glm::i32vec2 goal() const noexcept;
+
+    bool has_waypoint() const noexcept;
+    glm::i32vec2 next_waypoint() const noexcept;
+    void pop_waypoint() noexcept;
+};
+
+}
+
+#endif //MMAP_DEMO_PATH_HPP
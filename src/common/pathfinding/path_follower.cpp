@@ -0,0 +1,91 @@
+#include "path_follower.hpp"
+
+#include <cmath>
+
+namespace pathfinding {
+
+namespace {
+
+glm::i32vec2 tile_of(glm::vec2 position) noexcept {
+    return glm::i32vec2(static_cast<int>(std::floor(position.x)), static_cast<int>(std::floor(position.y)));
+}
+
+glm::vec2 center_of(glm::i32vec2 tile) noexcept {
+    return glm::vec2(tile.x + 0.5f, tile.y + 0.5f);
+}
+
+// Units closer than this to their target are snapped onto it by update_units
+const float ARRIVAL_DISTANCE = 0.1f;
+
+}
+
+path_follower::path_follower(hierarchical_pathfinder& pathfinder)
+: pathfinder(pathfinder) {
+
+}
+
+void path_follower::follow(unit& u, followed_path& followed) {
+    path& p = followed.waypoints;
+    while(!p.has_waypoint() && pathfinder.refine(p)) {
+
+    }
+
+    if(p.has_waypoint()) {
+        const glm::i32vec2 waypoint = p.next_waypoint();
+        p.pop_waypoint();
+
+        // The goal tile is replaced by the exact target
+        u.set_target_position(p.is_completed() ? followed.target : center_of(waypoint));
+    }
+}
+
+bool path_follower::order(unit& u, movement_class movement, glm::vec2 target) {
+    const glm::vec2 position(u.get_position().x, u.get_position().z);
+
+    path found_path = pathfinder.find_path(movement, tile_of(position), tile_of(target));
+    if(!found_path.found()) {
+        cancel(u.get_id());
+        return false;
+    }
+
+    followed_path& followed = paths[u.get_id()];
+    followed.waypoints = std::move(found_path);
+    followed.target = target;
+    follow(u, followed);
+
+    // A target on the tile of the unit gives no waypoint, it is walked to directly
+    if(followed.waypoints.is_completed()) {
+        u.set_target_position(target);
+        paths.erase(u.get_id());
+    }
+
+    return true;
+}
+
+void path_follower::cancel(uint32_t unit_id) {
+    paths.erase(unit_id);
+}
+
+void path_follower::advance(unit_manager& units) {
+    for(auto it = std::begin(paths); it != std::end(paths);) {
+        unit* u = static_cast<unit*>(units.get(it->first));
+        if(!u) {
+            it = paths.erase(it);
+            continue;
+        }
+
+        const glm::vec2 position(u->get_position().x, u->get_position().z);
+        if(glm::distance(position, u->get_target_position()) < ARRIVAL_DISTANCE) {
+            follow(*u, it->second);
+        }
+
+        if(it->second.waypoints.is_completed()) {
+            it = paths.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+}
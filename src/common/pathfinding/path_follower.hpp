@@ -0,0 +1,39 @@
+#ifndef MMAP_DEMO_PATH_FOLLOWER_HPP
+#define MMAP_DEMO_PATH_FOLLOWER_HPP
+
+#include "path.hpp"
+#include "hierarchical_pathfinder.hpp"
+#include "../actor/unit.hpp"
+#include "../actor/unit_manager.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+
+namespace pathfinding {
+
+// Keeps the path of every moving unit and feeds them their next waypoint
+class path_follower {
+    struct followed_path {
+        path waypoints;
+        glm::vec2 target;
+    };
+
+    hierarchical_pathfinder& pathfinder;
+    std::unordered_map<uint32_t, followed_path> paths;
+
+    void follow(unit& u, followed_path& followed);
+public:
+    explicit path_follower(hierarchical_pathfinder& pathfinder);
+
+    // Returns false when the target cannot be reached
+    bool order(unit& u, movement_class movement, glm::vec2 target);
+    void cancel(uint32_t unit_id);
+
+    // Must be called before updating units
+    void advance(unit_manager& units);
+};
+
+}
+
+#endif //MMAP_DEMO_PATH_FOLLOWER_HPP
@@ -5,37 +5,29 @@
 
 namespace task {
 
-update_player_visibility::update_player_visibility(uint8_t player, const visibility_map& v, unit_manager& units)
+update_player_visibility::update_player_visibility(uint8_t player, visibility_tracker& tracker, const visibility_map& current, visibility_map& next,
+                                                   unit_manager::snapshot_ptr units, const flyweight_table& flyweights)
 : player_id(player)
-, visibility_(v)
-, units_(units) {
+, tracker_(tracker)
+, current_(current)
+, next_(next)
+, units_(std::move(units))
+, flyweights_(flyweights) {
 
 }
 
 void update_player_visibility::execute() {
-    visibility_.clear();
-
-    std::vector<unit*> units;
-    units_.units_of(player_id, std::back_inserter(units));
-    std::for_each(std::begin(units), std::end(units), [this](unit* u) {
-        const int start_of_x = std::floor(u->get_position().x - u->visibility_radius());
-        const int start_of_y = std::floor(u->get_position().z - u->visibility_radius());
-        const int end_of_x = std::ceil(u->get_position().x + u->visibility_radius());
-        const int end_of_y = std::ceil(u->get_position().z + u->visibility_radius());
-
-        for(int y = std::max(0, start_of_y); y < std::min(static_cast<int>(visibility_.height()), end_of_y); ++y) {
-            for(int x = std::max(0, start_of_x); x < std::min(static_cast<int>(visibility_.width()), end_of_x); ++x) {
-                // Test each tiles
-                const glm::vec3 tile_pos(x, 0, y);
-                const glm::vec3 diff = tile_pos - u->get_position();
-                const float len = glm::length(diff);
-
-                if(len <= u->visibility_radius()) {
-                    visibility_.set(x, y, visibility::visible);
-                }
-            }
-        }
+    std::vector<const unit*> units;
+    units_->units_of(player_id, std::back_inserter(units));
+
+    std::vector<visibility_tracker::viewer> viewers;
+    viewers.reserve(units.size());
+    std::transform(std::begin(units), std::end(units), std::back_inserter(viewers), [this](const unit* u) {
+        return visibility_tracker::viewer{u->get_id(), glm::vec2(u->get_position().x, u->get_position().z),
+                                          flyweights_.stats_of(u->type()).visibility_radius};
     });
+
+    tracker_.update(viewers, current_, next_);
 }
 
 uint8_t update_player_visibility::get_player() const noexcept {
@@ -43,7 +35,7 @@ uint8_t update_player_visibility::get_player() const noexcept {
 }
 
 const visibility_map& update_player_visibility::visibility() const noexcept {
-    return visibility_;
+    return next_;
 }
 
-}
\ No newline at end of file
+}
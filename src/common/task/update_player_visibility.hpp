@@ -3,15 +3,22 @@
 
 #include "../async/task.hpp"
 #include "../world/visibility_map.hpp"
+#include "../world/visibility_tracker.hpp"
 #include "../actor/unit_manager.hpp"
 
 namespace task {
+// Writes the next visibility of a player in a back buffer while the current one stays readable,
+// the owner swaps both maps once the task is done
 class update_player_visibility : public async::base_task {
     uint8_t player_id;
-    visibility_map visibility_;
-    unit_manager& units_;
+    visibility_tracker& tracker_;
+    const visibility_map& current_;
+    visibility_map& next_;
+    unit_manager::snapshot_ptr units_;
+    const flyweight_table& flyweights_;
 public:
-    update_player_visibility(uint8_t player, const visibility_map& v, unit_manager& units);
+    update_player_visibility(uint8_t player, visibility_tracker& tracker, const visibility_map& current, visibility_map& next,
+                             unit_manager::snapshot_ptr units, const flyweight_table& flyweights);
 
     void execute() override;
     uint8_t get_player() const noexcept;
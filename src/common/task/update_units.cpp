@@ -1,61 +1,90 @@
 #include "update_units.hpp"
 
-namespace task {
-
-bool update_units::can_move(base_unit* unit, glm::vec3 position, world& w) noexcept {
-    if(unit) {
-        int chunk_x = static_cast<int>(position.x / world::CHUNK_WIDTH);
-        int chunk_z = static_cast<int>(position.z / world::CHUNK_DEPTH);
+#include <algorithm>
+#include <cmath>
 
-        const world_chunk* chunk = w.chunk_at(chunk_x, chunk_z);
-        if(chunk) {
-            const glm::vec3 chunk_space_position(position.x - chunk_x * world::CHUNK_WIDTH,
-                                                 position.y,
-                                                 position.z - chunk_z * world::CHUNK_DEPTH);
+namespace task {
 
-            return chunk->biome_at(chunk_space_position.x, 0, chunk_space_position.z) != BIOME_WATER;
-        }
-    }
+// Distance kept from the first blocked tile when a move is cut short
+static const float SHORE_MARGIN = 0.01f;
 
-    return false;
-}
-
-update_units::update_units(unit_manager &units, world& w, float elapsed_seconds)
+update_units::update_units(unit_manager &units, world& w, float elapsed_seconds, const std::vector<glm::vec2>& pushes)
 : units(units)
 , w(w)
-, elapsed_seconds(elapsed_seconds) {
+, elapsed_seconds(elapsed_seconds)
+, pushes(pushes) {
 
 }
 
 void update_units::execute() {
-    for (auto u = units.begin_of_units(); u != units.end_of_units(); u++) {
+    std::size_t i = 0;
+    for (auto u = units.begin_of_units(); u != units.end_of_units(); u++, i++) {
         auto actual_unit = u->second;
+        if(actual_unit->is_deferred()) {
+            continue;
+        }
+
+        const float unit_seconds = elapsed_seconds + actual_unit->take_deferred_seconds();
+        const unit_stats& stats = units.stats_of(*actual_unit);
 
+        const glm::vec3 position = actual_unit->get_position();
         const glm::vec2 target = actual_unit->get_target_position();
         const glm::vec3 target3D = { target.x, 0, target.y };
-        const glm::vec3 displacement = target3D - actual_unit->get_position();
+        const glm::vec3 displacement = target3D - position;
         const float len = glm::length(displacement);
+        const bool is_at_rest = len == 0.f;
 
+        glm::vec3 step{0.f, 0.f, 0.f};
         if(len > 0.f) {
-
             if(len < 0.1f) {
-                actual_unit->set_position(target3D);
+                step = displacement;
             }
             else {
-                glm::vec3 direction = glm::normalize(displacement);
+                // A unit catching up on deferred time must not overshoot its target
+                step = glm::normalize(displacement) * std::min(stats.speed * unit_seconds, len);
+            }
+        }
+
+        const glm::vec3 push = i < pushes.size() ? glm::vec3(pushes[i].x, 0.f, pushes[i].y) : glm::vec3(0.f, 0.f, 0.f);
+        auto trace_move = [this, &stats, position](glm::vec3 move) {
+            // Every tile crossed is tested, a long step must not jump over water
+            return w.trace_walkable(stats.movement, glm::vec2(position.x, position.z), glm::vec2(position.x + move.x, position.z + move.z));
+        };
+
+        glm::vec3 move = step + push;
+        if(glm::length(move) == 0.f) {
+            continue;
+        }
+        tile_trace trace = trace_move(move);
+
+        // A push against the shore is dropped, only the step toward the target can stop the unit
+        if(trace.is_blocked && glm::length(push) > 0.f) {
+            move = step;
+            if(len == 0.f) {
+                continue;
+            }
+            trace = trace_move(move);
+        }
+
+        const float move_length = glm::length(move);
 
-                glm::vec3 new_position =
-                        actual_unit->get_position() + (direction * actual_unit->get_speed() * elapsed_seconds);
+        const glm::vec3 new_position = position + move;
+        if (!trace.is_blocked) {
+            actual_unit->set_position(new_position);
 
-                if (can_move(actual_unit, new_position, w)) {
-                    actual_unit->set_position(new_position);
-                } else {
-                    actual_unit->set_target_position(
-                            glm::vec2(actual_unit->get_position().x, actual_unit->get_position().z));
-                }
+            // A unit at rest only moved because it was pushed, it stays where it was pushed
+            if(is_at_rest) {
+                actual_unit->set_target_position(glm::vec2(new_position.x, new_position.z));
             }
+        } else {
+            // Stops on the shore, just before the first blocked tile
+            const float travelled = std::max(trace.entry * move_length - SHORE_MARGIN, 0.f);
+            const glm::vec3 shore = position + move * (travelled / move_length);
+
+            actual_unit->set_position(shore);
+            actual_unit->set_target_position(glm::vec2(shore.x, shore.z));
         }
     }
 }
 
-}
\ No newline at end of file
+}
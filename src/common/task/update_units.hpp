@@ -5,15 +5,20 @@
 #include "../actor/unit_manager.hpp"
 #include "../world/world.hpp"
 
+#include <glm/glm.hpp>
+#include <vector>
+
 namespace task {
+// Moves every unit by its step toward its target plus its separation push, as a single traced move
 class update_units : public async::base_task {
     unit_manager& units;
     world& w;
     float elapsed_seconds;
 
-    static bool can_move(base_unit* unit, glm::vec3 position, world& w) noexcept;
+    // In the order of the units, must outlive the task
+    const std::vector<glm::vec2>& pushes;
 public:
-    update_units(unit_manager& units, world& w, float elapsed_seconds);
+    update_units(unit_manager& units, world& w, float elapsed_seconds, const std::vector<glm::vec2>& pushes);
     void execute() override;
 
 };
@@ -0,0 +1,97 @@
+#include "fixed_timestep.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace game_time {
+
+constexpr std::chrono::microseconds fixed_timestep::SPIN_MARGIN;
+
+fixed_timestep::fixed_timestep(duration step, uint32_t max_steps_per_frame)
+: step_(step)
+, max_steps_per_frame(std::max(max_steps_per_frame, 1u))
+, last_frame(clock_type::now()) {
+    samples_us.reserve(SAMPLE_COUNT);
+}
+
+fixed_timestep::duration fixed_timestep::step() const noexcept {
+    return step_;
+}
+
+fixed_timestep::time_point fixed_timestep::next_step_at() const noexcept {
+    return last_frame + (step_ - accumulated);
+}
+
+uint32_t fixed_timestep::advance(time_point now) {
+    accumulated += now - last_frame;
+    last_frame = now;
+
+    uint32_t due = 0;
+    while(accumulated >= step_ && due < max_steps_per_frame) {
+        accumulated -= step_;
+        ++due;
+    }
+
+    if(accumulated >= step_) {
+        dropped_steps += static_cast<uint64_t>(accumulated / step_);
+        accumulated %= step_;
+    }
+
+    steps += due;
+    if(due > 1) {
+        catch_up_steps += due - 1;
+    }
+
+    return due;
+}
+
+void fixed_timestep::record_step(duration cost) {
+    if(cost > step_) {
+        ++overruns;
+    }
+
+    const double cost_us = std::chrono::duration<double, std::micro>(cost).count();
+    if(samples_us.size() < SAMPLE_COUNT) {
+        samples_us.push_back(cost_us);
+    }
+    else {
+        samples_us[next_sample] = cost_us;
+    }
+    next_sample = (next_sample + 1) % SAMPLE_COUNT;
+}
+
+fixed_timestep::statistics fixed_timestep::stats() const {
+    statistics current;
+    current.steps = steps;
+    current.catch_up_steps = catch_up_steps;
+    current.overruns = overruns;
+    current.dropped_steps = dropped_steps;
+
+    if(!samples_us.empty()) {
+        std::vector<double> sorted = samples_us;
+        std::sort(sorted.begin(), sorted.end());
+        current.median_us = sorted[sorted.size() / 2];
+        current.p99_us = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        current.max_us = sorted.back();
+    }
+
+    return current;
+}
+
+void fixed_timestep::reset_stats() noexcept {
+    steps = catch_up_steps = overruns = dropped_steps = 0;
+    samples_us.clear();
+    next_sample = 0;
+}
+
+void fixed_timestep::sleep_until(time_point deadline) {
+    if(deadline - clock_type::now() > SPIN_MARGIN) {
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+    }
+
+    while(clock_type::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+}
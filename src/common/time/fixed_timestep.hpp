@@ -0,0 +1,77 @@
+#ifndef MMAP_DEMO_FIXED_TIMESTEP_HPP
+#define MMAP_DEMO_FIXED_TIMESTEP_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace game_time {
+
+// Runs a simulation at a fixed step whatever the duration of the frames.
+// The time elapsed between frames is accumulated and consumed one step at a time
+class fixed_timestep {
+public:
+    using clock_type = std::chrono::steady_clock;
+    using duration = clock_type::duration;
+    using time_point = clock_type::time_point;
+
+    // Sleeping is only accurate to about a millisecond, the end of a wait is spent spinning
+    static constexpr std::chrono::microseconds SPIN_MARGIN{1000};
+
+    static const std::size_t SAMPLE_COUNT = 1024;
+
+    struct statistics {
+        uint64_t steps = 0;
+
+        // Steps run after the first of a frame because the previous frames were late
+        uint64_t catch_up_steps = 0;
+
+        // Steps that took longer than the step itself
+        uint64_t overruns = 0;
+
+        // Steps given up because too many were late
+        uint64_t dropped_steps = 0;
+
+        // Cost of the recent steps
+        double median_us = 0.0;
+        double p99_us = 0.0;
+        double max_us = 0.0;
+    };
+private:
+    duration step_;
+    uint32_t max_steps_per_frame;
+    duration accumulated{0};
+    time_point last_frame;
+
+    uint64_t steps = 0;
+    uint64_t catch_up_steps = 0;
+    uint64_t overruns = 0;
+    uint64_t dropped_steps = 0;
+    std::vector<double> samples_us;
+    std::size_t next_sample = 0;
+
+public:
+    fixed_timestep(duration step, uint32_t max_steps_per_frame);
+
+    duration step() const noexcept;
+
+    // When the next step is due
+    time_point next_step_at() const noexcept;
+
+    // Accumulates the time elapsed since the last frame and returns how many steps must run now,
+    // the steps over the limit are dropped so a long stall does not snowball
+    uint32_t advance(time_point now);
+
+    // Records the cost of a step that just ran
+    void record_step(duration cost);
+
+    statistics stats() const;
+    void reset_stats() noexcept;
+
+    // Sleeps most of the wait then spins for the last part
+    static void sleep_until(time_point deadline);
+};
+
+}
+
+#endif //MMAP_DEMO_FIXED_TIMESTEP_HPP
@@ -0,0 +1,60 @@
+#ifndef MMAP_DEMO_SPAN_HPP
+#define MMAP_DEMO_SPAN_HPP
+
+#include <cstddef>
+
+namespace util {
+
+// Non owning view over contiguous elements, valid until the storage changes
+template<typename T>
+class span {
+    T* first;
+    std::size_t count;
+public:
+    using value_type = T;
+    using iterator = T*;
+
+    span() noexcept
+    : first{nullptr}
+    , count{0} {
+
+    }
+
+    span(T* first, std::size_t count) noexcept
+    : first{first}
+    , count{count} {
+
+    }
+
+    iterator begin() const noexcept {
+        return first;
+    }
+
+    iterator end() const noexcept {
+        return first + count;
+    }
+
+    T* data() const noexcept {
+        return first;
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    T& operator[](std::size_t index) const noexcept {
+        return first[index];
+    }
+
+    T& front() const noexcept {
+        return first[0];
+    }
+};
+
+}
+
+#endif //MMAP_DEMO_SPAN_HPP
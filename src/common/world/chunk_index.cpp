@@ -0,0 +1,54 @@
+#include "chunk_index.hpp"
+
+#include <algorithm>
+
+void chunk_index::resize_grid(int new_width, int new_depth) {
+    std::vector<uint32_t> resized(new_width * new_depth, NONE);
+    for(int z = 0; z < depth; ++z) {
+        std::copy_n(grid.begin() + z * width, width, resized.begin() + z * new_width);
+    }
+
+    grid = std::move(resized);
+    width = new_width;
+    depth = new_depth;
+}
+
+void chunk_index::insert_in_table(glm::i32vec2 position, uint32_t index) {
+    const std::size_t mask = table.size() - 1;
+    std::size_t i = hash(position.x, position.y) & mask;
+    while(table[i].index != NONE) {
+        i = (i + 1) & mask;
+    }
+
+    table[i] = slot{position, index};
+}
+
+void chunk_index::insert(int x, int z, uint32_t index) {
+    if(is_dense(x, z)) {
+        // Grows by doubling, a map generated row by row would resize on every chunk otherwise
+        if(x >= width || z >= depth) {
+            resize_grid(x >= width ? std::min(std::max(x + 1, width * 2), DENSE_LIMIT) : width,
+                        z >= depth ? std::min(std::max(z + 1, depth * 2), DENSE_LIMIT) : depth);
+        }
+
+        grid[z * width + x] = index;
+        return;
+    }
+
+    if((table_count + 1) * 2 > table.size()) {
+        std::vector<slot> previous(std::max<std::size_t>(table.size() * 2, 16), slot{glm::i32vec2(0, 0), NONE});
+        previous.swap(table);
+        for(const slot& s : previous) {
+            if(s.index != NONE) {
+                insert_in_table(s.position, s.index);
+            }
+        }
+    }
+
+    insert_in_table(glm::i32vec2(x, z), index);
+    ++table_count;
+}
+
+std::size_t chunk_index::memory_usage() const noexcept {
+    return grid.capacity() * sizeof(uint32_t) + table.capacity() * sizeof(slot);
+}
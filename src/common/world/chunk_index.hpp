@@ -0,0 +1,67 @@
+#ifndef MMAP_DEMO_CHUNK_INDEX_HPP
+#define MMAP_DEMO_CHUNK_INDEX_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Where each chunk is stored in the world. A dense grid covers the chunks near the origin,
+// the other ones go in an open addressing table
+class chunk_index {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    // Chunks farther away than this on an axis are kept in the table
+    static constexpr int DENSE_LIMIT = 256;
+private:
+    struct slot {
+        glm::i32vec2 position;
+        uint32_t index;
+    };
+
+    int width = 0;
+    int depth = 0;
+    std::vector<uint32_t> grid;
+
+    // The size is a power of two kept at least twice the count
+    std::vector<slot> table;
+    std::size_t table_count = 0;
+
+    static bool is_dense(int x, int z) noexcept {
+        return x >= 0 && z >= 0 && x < DENSE_LIMIT && z < DENSE_LIMIT;
+    }
+
+    static std::size_t hash(int x, int z) noexcept {
+        uint64_t h = static_cast<uint32_t>(x) * uint64_t{0x9E3779B97F4A7C15}
+                   ^ static_cast<uint32_t>(z) * uint64_t{0xC2B2AE3D27D4EB4F};
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+
+    void resize_grid(int new_width, int new_depth);
+    void insert_in_table(glm::i32vec2 position, uint32_t index);
+public:
+    uint32_t find(int x, int z) const noexcept {
+        if(is_dense(x, z)) {
+            return x < width && z < depth ? grid[z * width + x] : NONE;
+        }
+
+        if(table.empty()) {
+            return NONE;
+        }
+
+        const std::size_t mask = table.size() - 1;
+        for(std::size_t i = hash(x, z) & mask;; i = (i + 1) & mask) {
+            if(table[i].index == NONE || table[i].position == glm::i32vec2(x, z)) {
+                return table[i].index;
+            }
+        }
+    }
+
+    // The position must not be indexed yet
+    void insert(int x, int z, uint32_t index);
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_CHUNK_INDEX_HPP
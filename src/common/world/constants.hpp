@@ -19,6 +19,7 @@ enum {
     SITE_DEER,
     SITE_STONE,
     SITE_FISH,
+    SITE_COUNT
 };
 
 #endif //MMAP_DEMO_CONSTANTS_HPP
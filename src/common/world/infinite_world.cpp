@@ -1,11 +1,17 @@
 #include "world.hpp"
 
-#include <algorithm>
-#include <iterator>
-
 infinite_world::infinite_world(uint32_t seed, map_choice choice)
-: generator(seed, CHUNK_WIDTH, CHUNK_DEPTH, choice){
+: seed(seed)
+, choice(choice)
+, generator(seed, CHUNK_WIDTH, CHUNK_DEPTH, choice){
+
+}
 
+world_chunk& infinite_world::index_loaded(world_chunk& chunk) {
+    update_walkability(chunk.position().x, chunk.position().y);
+    update_sites(chunk.position().x, chunk.position().y);
+
+    return chunk;
 }
 
 world_chunk& infinite_world::generate_at(int x, int z) noexcept {
@@ -14,29 +20,138 @@ world_chunk& infinite_world::generate_at(int x, int z) noexcept {
     auto generated_chunk = generator.generate_chunk(x, 0, z);
     chunk.load(generated_chunk);
 
-    return chunk;
+    return index_loaded(chunk);
 }
 
-world_chunk* infinite_world::chunk_at(int x, int z) {
-    auto it = std::find_if(begin(), end(), [x, z](const world_chunk& chunk) {
-        return chunk.position() == world_chunk::position_type{x, z};
-    });
+void infinite_world::stream_with(task_pusher push, std::size_t max_in_flight) {
+    if(!streaming) {
+        streaming = std::make_shared<generation_queue>();
+        streaming->seed = seed;
+        streaming->choice = choice;
+    }
+
+    push_generation = std::move(push);
+    this->max_in_flight = std::max<std::size_t>(1, max_in_flight);
+}
+
+bool infinite_world::is_streaming() const noexcept {
+    return static_cast<bool>(push_generation);
+}
+
+void infinite_world::start_waiting() {
+    while(in_flight < max_in_flight && !waiting_chunks.empty()) {
+        const world_chunk::position_type pos = waiting_chunks.front();
+        waiting_chunks.pop_front();
+
+        std::shared_ptr<generation_queue> queue = streaming;
+        push_generation(async::make_task([queue, pos]() {
+            // Building a generator sets up every noise layer, the idle ones are reused
+            std::unique_ptr<world_generator> task_generator;
+            {
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                if(!queue->idle_generators.empty()) {
+                    task_generator = std::move(queue->idle_generators.back());
+                    queue->idle_generators.pop_back();
+                }
+            }
+
+            if(!task_generator) {
+                task_generator = std::make_unique<world_generator>(queue->seed, CHUNK_WIDTH, CHUNK_DEPTH, queue->choice);
+            }
+
+            auto chunk = std::make_unique<world_chunk>(pos.x, pos.y);
+            auto generated_chunk = task_generator->generate_chunk(pos.x, 0, pos.y);
+            chunk->load(generated_chunk);
+
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->idle_generators.push_back(std::move(task_generator));
+            queue->finished.push_back(std::move(chunk));
+        }));
+
+        ++in_flight;
+    }
+}
+
+bool infinite_world::request(int x, int z) {
+    if(has_chunk(x, z)) {
+        return true;
+    }
+
+    if(!is_streaming()) {
+        generate_at(x, z);
+        return true;
+    }
 
-    if(it == end()) {
-        return &generate_at(x, z);
+    if(requested_chunks.find(x, z) == chunk_index::NONE) {
+        requested_chunks.insert(x, z, 0);
+        waiting_chunks.emplace_back(x, z);
+        start_waiting();
     }
 
-    return &(*it);
+    return false;
 }
 
-const world_chunk* infinite_world::chunk_at(int x, int z) const {
-    auto it = std::find_if(begin(), end(), [x, z](const world_chunk& chunk) {
-        return chunk.position() == world_chunk::position_type{x, z};
-    });
+void infinite_world::prefetch_around(glm::i32vec2 center, int ring) {
+    for(int distance = 0; distance <= ring; ++distance) {
+        for(int x = center.x - distance; x <= center.x + distance; ++x) {
+            for(int z = center.y - distance; z <= center.y + distance; ++z) {
+                // Only the border of this ring, the inner chunks were requested before
+                const bool is_border = x == center.x - distance || x == center.x + distance
+                                    || z == center.y - distance || z == center.y + distance;
+
+                // The tiles before the origin are never walkable, nothing goes there
+                if(is_border && x >= 0 && z >= 0) {
+                    request(x, z);
+                }
+            }
+        }
+    }
+}
+
+std::vector<world_chunk::position_type> infinite_world::publish_generated() {
+    std::vector<world_chunk::position_type> published;
+    if(!streaming) {
+        return published;
+    }
 
-    if(it == end()) {
-        return nullptr;
+    std::vector<std::unique_ptr<world_chunk>> finished;
+    {
+        std::lock_guard<std::mutex> lock(streaming->mutex);
+        finished.swap(streaming->finished);
     }
 
-    return &(*it);
-}
\ No newline at end of file
+    for(std::unique_ptr<world_chunk>& chunk : finished) {
+        const world_chunk::position_type pos = chunk->position();
+        if(!has_chunk(pos.x, pos.y)) {
+            index_loaded(add(std::move(*chunk)));
+            published.push_back(pos);
+        }
+    }
+
+    in_flight -= finished.size();
+    start_waiting();
+
+    return published;
+}
+
+std::size_t infinite_world::pending_count() const noexcept {
+    return waiting_chunks.size() + in_flight;
+}
+
+world_chunk* infinite_world::chunk_at(int x, int z) {
+    world_chunk* chunk = world::chunk_at(x, z);
+    if(!chunk) {
+        // Not ready yet when streaming, the caller tries again once it is published
+        return request(x, z) ? world::chunk_at(x, z) : nullptr;
+    }
+
+    return chunk;
+}
+
+const world_chunk* infinite_world::chunk_at(int x, int z) const {
+    return world::chunk_at(x, z);
+}
+
+bool infinite_world::is_chunk_generated(int x, int z) const noexcept {
+    return has_chunk(x, z);
+}
@@ -0,0 +1,31 @@
+#include "movement_class.hpp"
+
+int biome_id_of(biome_type type) noexcept {
+    switch(type) {
+        case biome_type::grass:
+            return BIOME_GRASS;
+        case biome_type::rock:
+            return BIOME_ROCK;
+        case biome_type::snow:
+            return BIOME_SNOW;
+        case biome_type::desert:
+            return BIOME_DESERT;
+        case biome_type::water:
+            return BIOME_WATER;
+        default:
+            return BIOME_COUNT;
+    }
+}
+
+movement_class make_movement_class(const std::vector<biome_type>& walkable_biomes) noexcept {
+    movement_class movement = 0;
+    for(biome_type type : walkable_biomes) {
+        const int biome = biome_id_of(type);
+
+        if(biome < BIOME_COUNT) {
+            movement |= static_cast<movement_class>(1 << biome);
+        }
+    }
+
+    return movement;
+}
@@ -0,0 +1,23 @@
+#ifndef MMAP_DEMO_MOVEMENT_CLASS_HPP
+#define MMAP_DEMO_MOVEMENT_CLASS_HPP
+
+#include "biome_type.hpp"
+#include "constants.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// The set of biomes a unit can walk on, one bit per BIOME_* value
+using movement_class = uint8_t;
+
+static_assert(BIOME_COUNT <= 8, "movement_class cannot hold every biome");
+
+int biome_id_of(biome_type type) noexcept;
+
+movement_class make_movement_class(const std::vector<biome_type>& walkable_biomes) noexcept;
+
+inline bool can_walk_on(movement_class movement, int biome) noexcept {
+    return biome >= 0 && biome < BIOME_COUNT && ((movement >> biome) & 1) != 0;
+}
+
+#endif //MMAP_DEMO_MOVEMENT_CLASS_HPP
@@ -0,0 +1,205 @@
+#include "occupancy_map.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+
+static_assert(occupancy_map::WORD_BITS % world::CHUNK_WIDTH == 0, "a chunk row must fit in a single word");
+static_assert(occupancy_map::MAX_FOOTPRINT <= static_cast<int>(world::CHUNK_WIDTH), "a footprint must fit in a chunk row");
+
+namespace {
+
+using chunk_row = uint32_t;
+
+static_assert(sizeof(chunk_row) * 8 == world::CHUNK_WIDTH, "a chunk row must fill its mask");
+
+bool is_blocking(int biome, util::span<const site> sites) noexcept {
+    return biome == BIOME_WATER || std::any_of(std::begin(sites), std::end(sites), [](const site& s) {
+        return s.type() != SITE_NOTHING && !s.is_depleted();
+    });
+}
+
+// Bit i is set when the bits i to i + length - 1 are all set
+chunk_row runs_of(chunk_row bits, int length) noexcept {
+    for(int covered = 1; covered < length;) {
+        const int shift = std::min(covered, length - covered);
+        bits &= bits >> shift;
+        covered += shift;
+    }
+
+    return bits;
+}
+
+}
+
+void occupancy_map::resize(int new_width, int new_depth) {
+    const std::size_t new_stride = (new_width + WORD_BITS - 1) / WORD_BITS;
+
+    for(std::vector<word_type>* bitmap : {&terrain, &buildings}) {
+        std::vector<word_type> resized(new_stride * new_depth, 0);
+        for(int z = 0; z < depth; ++z) {
+            std::copy_n(bitmap->begin() + z * stride, stride, resized.begin() + z * new_stride);
+        }
+
+        *bitmap = std::move(resized);
+    }
+
+    width = new_width;
+    depth = new_depth;
+    stride = new_stride;
+}
+
+occupancy_map::word_type occupancy_map::row_bits(int x, int z, int count) const noexcept {
+    const word_type count_mask = count >= WORD_BITS ? ~word_type{0} : (word_type{1} << count) - 1;
+    if(x < 0 || z < 0 || z >= depth || x >= width) {
+        return count_mask;
+    }
+
+    const std::size_t word = z * stride + x / WORD_BITS;
+    const int shift = x % WORD_BITS;
+
+    word_type bits = (terrain[word] | buildings[word]) >> shift;
+    if(shift > 0 && static_cast<std::size_t>(x / WORD_BITS + 1) < stride) {
+        bits |= (terrain[word + 1] | buildings[word + 1]) << (WORD_BITS - shift);
+    }
+
+    // Tiles past the edge of the map
+    if(x + count > width) {
+        bits |= ~word_type{0} << (width - x);
+    }
+
+    return bits & count_mask;
+}
+
+void occupancy_map::set_buildings(int x, int z, int footprint_width, int footprint_depth, bool is_built) noexcept {
+    const int end_x = std::min(x + footprint_width, width);
+    const int end_z = std::min(z + footprint_depth, depth);
+    for(int row = std::max(z, 0); row < end_z; ++row) {
+        for(int column = std::max(x, 0); column < end_x; ++column) {
+            word_type& word = buildings[row * stride + column / WORD_BITS];
+            const word_type bit = word_type{1} << (column % WORD_BITS);
+            word = is_built ? word | bit : word & ~bit;
+        }
+    }
+}
+
+void occupancy_map::update(const world_chunk& chunk) {
+    const world_chunk::position_type pos = chunk.position();
+    if(pos.x < 0 || pos.y < 0) {
+        return;
+    }
+
+    const int start_x = pos.x * static_cast<int>(world::CHUNK_WIDTH);
+    const int start_z = pos.y * static_cast<int>(world::CHUNK_DEPTH);
+    const int end_x = start_x + static_cast<int>(world::CHUNK_WIDTH);
+    const int end_z = start_z + static_cast<int>(world::CHUNK_DEPTH);
+    if(end_x > width || end_z > depth) {
+        resize(std::max(width, end_x), std::max(depth, end_z));
+    }
+
+    std::vector<chunk_row> rows(world::CHUNK_DEPTH, 0);
+    for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+        for(int x = 0; x < static_cast<int>(world::CHUNK_WIDTH); ++x) {
+            if(chunk.biome_at(x, 0, z) == BIOME_WATER) {
+                rows[z] |= chunk_row{1} << x;
+            }
+        }
+    }
+
+    chunk.for_each_site([&rows](const glm::i32vec3& position, const site& s) {
+        if(s.type() != SITE_NOTHING && !s.is_depleted()) {
+            rows[position.z] |= chunk_row{1} << position.x;
+        }
+    });
+
+    const int shift = start_x % WORD_BITS;
+    const word_type chunk_mask = word_type{static_cast<chunk_row>(~chunk_row{0})} << shift;
+    for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+        word_type& word = terrain[(start_z + z) * stride + start_x / WORD_BITS];
+        word = (word & ~chunk_mask) | (word_type{rows[z]} << shift);
+    }
+}
+
+void occupancy_map::update_tile(const world_chunk& chunk, int x, int z) {
+    const int tile_x = chunk.position().x * static_cast<int>(world::CHUNK_WIDTH) + x;
+    const int tile_z = chunk.position().y * static_cast<int>(world::CHUNK_DEPTH) + z;
+    if(tile_x < 0 || tile_z < 0 || tile_x >= width || tile_z >= depth) {
+        return;
+    }
+
+    word_type& word = terrain[tile_z * stride + tile_x / WORD_BITS];
+    const word_type bit = word_type{1} << (tile_x % WORD_BITS);
+    word = is_blocking(chunk.biome_at(x, 0, z), chunk.sites_at(x, 0, z)) ? word | bit : word & ~bit;
+}
+
+bool occupancy_map::is_occupied(int x, int z) const noexcept {
+    return row_bits(x, z, 1) != 0;
+}
+
+bool occupancy_map::fits(int x, int z, int footprint_width, int footprint_depth) const noexcept {
+    if(footprint_width <= 0 || footprint_depth <= 0 || footprint_width > MAX_FOOTPRINT) {
+        return false;
+    }
+
+    for(int row = z; row < z + footprint_depth; ++row) {
+        if(row_bits(x, row, footprint_width) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void occupancy_map::place(int x, int z, int footprint_width, int footprint_depth) noexcept {
+    set_buildings(x, z, footprint_width, footprint_depth, true);
+}
+
+void occupancy_map::remove(int x, int z, int footprint_width, int footprint_depth) noexcept {
+    set_buildings(x, z, footprint_width, footprint_depth, false);
+}
+
+std::vector<glm::i32vec2> occupancy_map::free_spots_in(int chunk_x, int chunk_z, int footprint_width, int footprint_depth) const {
+    std::vector<glm::i32vec2> spots;
+
+    const int chunk_width = static_cast<int>(world::CHUNK_WIDTH);
+    const int chunk_depth = static_cast<int>(world::CHUNK_DEPTH);
+    if(footprint_width <= 0 || footprint_depth <= 0 || footprint_width > chunk_width || footprint_depth > chunk_depth) {
+        return spots;
+    }
+
+    // Bit x of a row is set when the footprint starting at x fits horizontally
+    const int start_x = chunk_x * chunk_width;
+    const int start_z = chunk_z * chunk_depth;
+    std::vector<chunk_row> fitting_rows(chunk_depth);
+    for(int z = 0; z < chunk_depth; ++z) {
+        const chunk_row free_tiles = static_cast<chunk_row>(~row_bits(start_x, start_z + z, chunk_width));
+        fitting_rows[z] = runs_of(free_tiles, footprint_width);
+    }
+
+    // Sliding AND over the rows, doubling the window like the columns
+    for(int covered = 1; covered < footprint_depth;) {
+        const int shift = std::min(covered, footprint_depth - covered);
+        for(int z = 0; z + shift < chunk_depth; ++z) {
+            fitting_rows[z] &= fitting_rows[z + shift];
+        }
+        for(int z = chunk_depth - shift; z < chunk_depth; ++z) {
+            fitting_rows[z] = 0;
+        }
+        covered += shift;
+    }
+
+    for(int z = 0; z + footprint_depth <= chunk_depth; ++z) {
+        for(chunk_row bits = fitting_rows[z]; bits != 0; bits &= bits - 1) {
+            int x = 0;
+            while(((bits >> x) & 1) == 0) {
+                ++x;
+            }
+            spots.emplace_back(start_x + x, start_z + z);
+        }
+    }
+
+    return spots;
+}
+
+std::size_t occupancy_map::memory_usage() const noexcept {
+    return (terrain.capacity() + buildings.capacity()) * sizeof(word_type);
+}
@@ -0,0 +1,58 @@
+#ifndef MMAP_DEMO_OCCUPANCY_MAP_HPP
+#define MMAP_DEMO_OCCUPANCY_MAP_HPP
+
+#include "world_chunk.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// One packed bit per tile of the world telling if something stands on it:
+// water, a site that is not depleted or the footprint of a building.
+// Footprints are tested a row of tiles at a time with masks
+class occupancy_map {
+public:
+    using word_type = uint64_t;
+
+    static constexpr int WORD_BITS = 64;
+
+    // Widest footprint that can be tested
+    static constexpr int MAX_FOOTPRINT = 32;
+private:
+    int width = 0;
+    int depth = 0;
+    std::size_t stride = 0;
+
+    // Water and sites come from the chunks, buildings are placed by the game
+    std::vector<word_type> terrain;
+    std::vector<word_type> buildings;
+
+    void resize(int new_width, int new_depth);
+
+    // Occupied bits of count tiles starting at x, tiles out of the map are occupied
+    word_type row_bits(int x, int z, int count) const noexcept;
+
+    void set_buildings(int x, int z, int footprint_width, int footprint_depth, bool is_built) noexcept;
+
+public:
+    // Rewrites the terrain bits of this chunk from its biomes and sites
+    void update(const world_chunk& chunk);
+
+    // Recomputes a single tile once its sites changed
+    void update_tile(const world_chunk& chunk, int x, int z);
+
+    bool is_occupied(int x, int z) const noexcept;
+
+    // True when every tile of the footprint whose top left corner is (x, z) is free
+    bool fits(int x, int z, int footprint_width, int footprint_depth) const noexcept;
+
+    void place(int x, int z, int footprint_width, int footprint_depth) noexcept;
+    void remove(int x, int z, int footprint_width, int footprint_depth) noexcept;
+
+    // Top left corners of every footprint fitting entirely in the chunk
+    std::vector<glm::i32vec2> free_spots_in(int chunk_x, int chunk_z, int footprint_width, int footprint_depth) const;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_OCCUPANCY_MAP_HPP
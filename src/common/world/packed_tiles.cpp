@@ -0,0 +1,58 @@
+#include "packed_tiles.hpp"
+
+#include <algorithm>
+#include <array>
+
+void packed_tiles::pack(const uint8_t* values, std::size_t count) {
+    // Palette in the order the values first appear
+    std::array<int16_t, 256> palette_index;
+    palette_index.fill(-1);
+    palette.clear();
+    for(std::size_t i = 0; i < count; ++i) {
+        if(palette_index[values[i]] < 0) {
+            palette_index[values[i]] = static_cast<int16_t>(palette.size());
+            palette.push_back(values[i]);
+        }
+    }
+
+    bits = 0;
+    while((std::size_t{1} << bits) < palette.size()) {
+        bits = bits == 0 ? 1 : bits * 2;
+    }
+
+    words.assign(bits == 0 ? 0 : (count * bits + WORD_BITS - 1) / WORD_BITS, 0);
+    for(std::size_t i = 0; bits > 0 && i < count; ++i) {
+        const std::size_t bit = i * bits;
+        words[bit / WORD_BITS] |= static_cast<word_type>(palette_index[values[i]]) << (bit % WORD_BITS);
+    }
+
+    palette.shrink_to_fit();
+    words.shrink_to_fit();
+}
+
+void packed_tiles::unpack(uint8_t* values, std::size_t count) const noexcept {
+    if(bits == 0) {
+        std::fill_n(values, count, palette.empty() ? 0 : palette.front());
+        return;
+    }
+
+    for(std::size_t i = 0; i < count; ++i) {
+        values[i] = at(i);
+    }
+}
+
+void packed_tiles::clear() noexcept {
+    palette.clear();
+    palette.shrink_to_fit();
+    words.clear();
+    words.shrink_to_fit();
+    bits = 0;
+}
+
+int packed_tiles::index_bits() const noexcept {
+    return bits;
+}
+
+std::size_t packed_tiles::memory_usage() const noexcept {
+    return palette.capacity() * sizeof(uint8_t) + words.capacity() * sizeof(word_type);
+}
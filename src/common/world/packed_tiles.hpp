@@ -0,0 +1,40 @@
+#ifndef MMAP_DEMO_PACKED_TILES_HPP
+#define MMAP_DEMO_PACKED_TILES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One byte per tile stored as an index in the palette of the distinct values. The indices use
+// 1, 2, 4 or 8 bits so they never straddle two words, a tile of a single value stores none
+class packed_tiles {
+public:
+    using word_type = uint64_t;
+
+    static constexpr int WORD_BITS = 64;
+private:
+    std::vector<uint8_t> palette;
+    std::vector<word_type> words;
+    int bits = 0;
+public:
+    void pack(const uint8_t* values, std::size_t count);
+    void unpack(uint8_t* values, std::size_t count) const noexcept;
+    void clear() noexcept;
+
+    uint8_t at(std::size_t index) const noexcept {
+        if(bits == 0) {
+            return palette.empty() ? 0 : palette.front();
+        }
+
+        const std::size_t bit = index * bits;
+        const word_type mask = (word_type{1} << bits) - 1;
+        return palette[(words[bit / WORD_BITS] >> (bit % WORD_BITS)) & mask];
+    }
+
+    // Bits used by the index of a tile
+    int index_bits() const noexcept;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_PACKED_TILES_HPP
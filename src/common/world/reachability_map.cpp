@@ -0,0 +1,119 @@
+#include "reachability_map.hpp"
+
+std::size_t reachability_map::index_of(tile_position tile) const noexcept {
+    return static_cast<std::size_t>(tile.y) * width + tile.x;
+}
+
+bool reachability_map::contains(tile_position tile) const noexcept {
+    return tile.x >= 0 && tile.y >= 0 && tile.x < width && tile.y < depth;
+}
+
+reachability_map::label_type reachability_map::find_root(std::vector<label_type>& parents, label_type tile) noexcept {
+    while(parents[tile] != tile) {
+        // Path halving
+        parents[tile] = parents[parents[tile]];
+        tile = parents[tile];
+    }
+
+    return tile;
+}
+
+void reachability_map::merge(std::vector<label_type>& parents, label_type a, label_type b) noexcept {
+    label_type root_a = find_root(parents, a);
+    label_type root_b = find_root(parents, b);
+
+    // The smallest index stays the root so labels do not depend on the merge order
+    if(root_a < root_b) {
+        parents[root_b] = root_a;
+    }
+    else if(root_b < root_a) {
+        parents[root_a] = root_b;
+    }
+}
+
+void reachability_map::label_band(const walkability_map& walkable, movement_class movement, int chunk_z, std::vector<label_type>& parents) const {
+    const int band_start = chunk_z * static_cast<int>(world::CHUNK_DEPTH);
+    const int band_end = band_start + static_cast<int>(world::CHUNK_DEPTH);
+
+    for(int z = band_start; z < band_end; ++z) {
+        for(int x = 0; x < width; ++x) {
+            if(!walkable.is_walkable(movement, x, z)) {
+                continue;
+            }
+
+            const auto index = static_cast<label_type>(index_of({x, z}));
+            parents[index] = index;
+
+            // Left and top neighbours are already labeled, the band above is merged later
+            if(x > 0 && parents[index - 1] != UNWALKABLE) {
+                merge(parents, index, index - 1);
+            }
+
+            if(z > band_start && parents[index - width] != UNWALKABLE) {
+                merge(parents, index, index - width);
+            }
+        }
+    }
+}
+
+void reachability_map::merge_bands(std::vector<label_type>& parents) const {
+    for(int z = static_cast<int>(world::CHUNK_DEPTH); z < depth; z += world::CHUNK_DEPTH) {
+        for(int x = 0; x < width; ++x) {
+            const auto index = static_cast<label_type>(index_of({x, z}));
+            if(parents[index] != UNWALKABLE && parents[index - width] != UNWALKABLE) {
+                merge(parents, index, index - width);
+            }
+        }
+    }
+}
+
+void reachability_map::flatten_band(int chunk_z, const std::vector<label_type>& parents, std::vector<label_type>& result) const {
+    const int band_start = chunk_z * static_cast<int>(world::CHUNK_DEPTH);
+    const int band_end = band_start + static_cast<int>(world::CHUNK_DEPTH);
+
+    for(std::size_t index = index_of({0, band_start}); index < index_of({0, band_end}); ++index) {
+        label_type root = parents[index];
+        if(root == UNWALKABLE) {
+            continue;
+        }
+
+        // Parents are shared between bands at this point, they are only read
+        while(parents[root] != root) {
+            root = parents[root];
+        }
+
+        result[index] = root;
+    }
+}
+
+bool reachability_map::is_built(movement_class movement) const noexcept {
+    return labels.find(movement) != labels.end();
+}
+
+reachability_map::label_type reachability_map::label_at(movement_class movement, tile_position tile) const noexcept {
+    auto it = labels.find(movement);
+    if(it == labels.end() || !contains(tile)) {
+        return UNWALKABLE;
+    }
+
+    return it->second[index_of(tile)];
+}
+
+bool reachability_map::can_reach(movement_class movement, tile_position from, tile_position to) const noexcept {
+    if(!is_built(movement)) {
+        return true;
+    }
+
+    const label_type from_label = label_at(movement, from);
+
+    return from_label != UNWALKABLE && from_label == label_at(movement, to);
+}
+
+std::size_t reachability_map::memory_usage() const noexcept {
+    std::size_t bytes = 0;
+    for(const auto& pair : labels) {
+        bytes += pair.second.capacity() * sizeof(label_type);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,85 @@
+#ifndef MMAP_DEMO_REACHABILITY_MAP_HPP
+#define MMAP_DEMO_REACHABILITY_MAP_HPP
+
+#include "world.hpp"
+#include "walkability_map.hpp"
+#include "movement_class.hpp"
+#include "../async/task_executor.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Labels the connected walkable regions of the world for each movement class,
+// two tiles can reach each other only when they share the same label
+class reachability_map {
+public:
+    using label_type = uint32_t;
+    using tile_position = glm::i32vec2;
+
+    static constexpr label_type UNWALKABLE = std::numeric_limits<label_type>::max();
+private:
+    int width = 0;
+    int depth = 0;
+    std::unordered_map<movement_class, std::vector<label_type>> labels;
+
+    std::size_t index_of(tile_position tile) const noexcept;
+    bool contains(tile_position tile) const noexcept;
+
+    static label_type find_root(std::vector<label_type>& parents, label_type tile) noexcept;
+    static void merge(std::vector<label_type>& parents, label_type a, label_type b) noexcept;
+
+    // Each band is a row of chunks, bands are independent until merged
+    void label_band(const walkability_map& walkable, movement_class movement, int chunk_z, std::vector<label_type>& parents) const;
+    void merge_bands(std::vector<label_type>& parents) const;
+    void flatten_band(int chunk_z, const std::vector<label_type>& parents, std::vector<label_type>& result) const;
+
+public:
+    // Every tile of chunk_count chunks is labeled in parallel, push must forward the tasks to an executor.
+    // Only the bitmaps are read, a copy can be labeled while the world keeps changing
+    template<typename TaskPusher>
+    void build(const walkability_map& walkable, glm::i32vec2 chunk_count, movement_class movement, TaskPusher push) {
+        width = chunk_count.x * static_cast<int>(world::CHUNK_WIDTH);
+        depth = chunk_count.y * static_cast<int>(world::CHUNK_DEPTH);
+
+        std::vector<label_type> parents(static_cast<std::size_t>(width) * depth, UNWALKABLE);
+        std::vector<async::task_executor::task_future> bands;
+        for(int z = 0; z < chunk_count.y; ++z) {
+            bands.push_back(push(async::make_task([this, &walkable, movement, z, &parents]() {
+                label_band(walkable, movement, z, parents);
+            })));
+        }
+
+        for(auto& band : bands) {
+            band.wait();
+        }
+        bands.clear();
+
+        merge_bands(parents);
+
+        std::vector<label_type>& result = labels[movement];
+        result.assign(parents.size(), UNWALKABLE);
+        for(int z = 0; z < chunk_count.y; ++z) {
+            bands.push_back(push(async::make_task([this, z, &parents, &result]() {
+                flatten_band(z, parents, result);
+            })));
+        }
+
+        for(auto& band : bands) {
+            band.wait();
+        }
+    }
+
+    bool is_built(movement_class movement) const noexcept;
+
+    label_type label_at(movement_class movement, tile_position tile) const noexcept;
+
+    // A movement class that was never built is considered able to reach anything
+    bool can_reach(movement_class movement, tile_position from, tile_position to) const noexcept;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_REACHABILITY_MAP_HPP
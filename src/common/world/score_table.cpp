@@ -0,0 +1,82 @@
+#include "score_table.hpp"
+
+score_table::sum_type score_table::biome_score(int biome) noexcept {
+    switch(biome) {
+        case BIOME_GRASS:
+            return 10;
+        case BIOME_ROCK:
+            return 5;
+        case BIOME_DESERT:
+        case BIOME_SNOW:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+score_table::sum_type score_table::site_score(int type) noexcept {
+    switch(type) {
+        case SITE_TREE:
+            return 10;
+        case SITE_BERRY:
+        case SITE_DEER:
+            return 8;
+        case SITE_STONE:
+        case SITE_MAGIC_ESSENCE:
+        case SITE_GOLD:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+void score_table::sum_rows(const world& w, int first, int last) noexcept {
+    const int chunk_width = static_cast<int>(world::CHUNK_WIDTH);
+    const int chunk_depth = static_cast<int>(world::CHUNK_DEPTH);
+
+    for(int z = first; z < last; ++z) {
+        sum_type* biome_row = &biome_sums[index_of(0, z + 1)];
+        sum_type* site_row = &site_sums[index_of(0, z + 1)];
+
+        sum_type biome_sum = 0;
+        sum_type site_sum = 0;
+        for(int chunk_x = 0; chunk_x * chunk_width < width; ++chunk_x) {
+            const world_chunk* chunk = w.chunk_at(chunk_x, z / chunk_depth);
+            for(int x = 0; x < chunk_width; ++x) {
+                if(chunk) {
+                    biome_sum += biome_score(chunk->biome_at(x, 0, z % chunk_depth));
+
+                    const util::span<const site> sites = chunk->sites_at(x, 0, z % chunk_depth);
+                    if(!sites.empty()) {
+                        site_sum += site_score(sites.front().type());
+                    }
+                }
+
+                biome_row[chunk_x * chunk_width + x + 1] = biome_sum;
+                site_row[chunk_x * chunk_width + x + 1] = site_sum;
+            }
+        }
+    }
+}
+
+void score_table::sum_columns(int first, int last) noexcept {
+    for(int z = 1; z <= depth; ++z) {
+        const std::size_t row = index_of(first + 1, z);
+        const std::size_t previous_row = index_of(first + 1, z - 1);
+        for(int x = 0; x < last - first; ++x) {
+            biome_sums[row + x] += biome_sums[previous_row + x];
+            site_sums[row + x] += site_sums[previous_row + x];
+        }
+    }
+}
+
+void score_table::assign(int table_width, int table_depth, util::span<const sum_type> biomes, util::span<const sum_type> sites) {
+    width = table_width;
+    depth = table_depth;
+    biome_sums.assign(biomes.begin(), biomes.end());
+    site_sums.assign(sites.begin(), sites.end());
+}
+
+std::size_t score_table::memory_usage() const noexcept {
+    return (biome_sums.capacity() + site_sums.capacity()) * sizeof(sum_type);
+}
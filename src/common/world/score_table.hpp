@@ -0,0 +1,136 @@
+#ifndef MMAP_DEMO_SCORE_TABLE_HPP
+#define MMAP_DEMO_SCORE_TABLE_HPP
+
+#include "world.hpp"
+#include "../async/task.hpp"
+#include "../async/task_executor.hpp"
+#include "../util/span.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Summed-area tables of the biome and site scores of every tile, built once after the generation.
+// The score of any rectangle of tiles is then read from its four corners. Sites depleted
+// afterward still count, the table is a snapshot of the generated world
+class score_table {
+public:
+    using sum_type = uint32_t;
+private:
+    int width = 0;
+    int depth = 0;
+
+    // (width + 1) x (depth + 1) sums, the first row and column are zeros
+    std::vector<sum_type> biome_sums;
+    std::vector<sum_type> site_sums;
+
+    std::size_t index_of(int x, int z) const noexcept {
+        return static_cast<std::size_t>(z) * (width + 1) + x;
+    }
+
+    static sum_type sum_in(const std::vector<sum_type>& sums, std::size_t left_top, std::size_t right_top,
+                           std::size_t left_bottom, std::size_t right_bottom) noexcept {
+        return sums[right_bottom] - sums[right_top] - sums[left_bottom] + sums[left_top];
+    }
+
+    // Prefix sums along x of the tiles of rows [first, last)
+    void sum_rows(const world& w, int first, int last) noexcept;
+
+    // Prefix sums along z of the columns [first, last), once every row is summed
+    void sum_columns(int first, int last) noexcept;
+
+    template<typename Sum>
+    double sum_over(int x, int z, int area_width, int area_depth, Sum sum) const noexcept {
+        const int left = std::max(x, 0);
+        const int top = std::max(z, 0);
+        const int right = std::min(x + area_width, width);
+        const int bottom = std::min(z + area_depth, depth);
+        if(left >= right || top >= bottom) {
+            return 0.0;
+        }
+
+        return sum(index_of(left, top), index_of(right, top), index_of(left, bottom), index_of(right, bottom));
+    }
+public:
+    static sum_type biome_score(int biome) noexcept;
+    static sum_type site_score(int type) noexcept;
+
+    // Covers the tiles of the chunks of the world, the missing chunks score nothing. Rows, then
+    // columns, are split in band_count bands summed by tasks forwarded to push
+    template<typename TaskPusher>
+    void build(const world& w, std::size_t band_count, TaskPusher push) {
+        const glm::i32vec2 chunks = w.size();
+        width = chunks.x * static_cast<int>(world::CHUNK_WIDTH);
+        depth = chunks.y * static_cast<int>(world::CHUNK_DEPTH);
+        biome_sums.assign(static_cast<std::size_t>(width + 1) * (depth + 1), 0);
+        site_sums.assign(biome_sums.size(), 0);
+
+        auto run_bands = [band_count, &push](int count, auto sum_band) {
+            const int bands = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(band_count, std::max(count, 1))));
+            std::vector<async::task_executor::task_future> futures;
+            for(int band = 0; band < bands; ++band) {
+                const int first = count * band / bands;
+                const int last = count * (band + 1) / bands;
+                futures.push_back(push(async::make_task([first, last, &sum_band]() {
+                    sum_band(first, last);
+                })));
+            }
+
+            for(auto& future : futures) {
+                future.wait();
+            }
+        };
+
+        run_bands(depth, [this, &w](int first, int last) {
+            sum_rows(w, first, last);
+        });
+        run_bands(width, [this](int first, int last) {
+            sum_columns(first, last);
+        });
+    }
+
+    // Takes the sums of a table of table_width x table_depth tiles, as given by biome_table and site_table
+    void assign(int table_width, int table_depth, util::span<const sum_type> biomes, util::span<const sum_type> sites);
+
+    // Sums row by row, (width + 1) x (depth + 1) with the zeros of the first row and column
+    util::span<const sum_type> biome_table() const noexcept {
+        return util::span<const sum_type>(biome_sums.data(), biome_sums.size());
+    }
+
+    util::span<const sum_type> site_table() const noexcept {
+        return util::span<const sum_type>(site_sums.data(), site_sums.size());
+    }
+
+    // Tiles covered on each axis, starting at the origin
+    glm::i32vec2 size() const noexcept {
+        return glm::i32vec2(width, depth);
+    }
+
+    // Scores of the tiles of [x, x + area_width) x [z, z + area_depth), clipped to the table
+    double biome_score_in(int x, int z, int area_width, int area_depth) const noexcept {
+        return sum_over(x, z, area_width, area_depth, [this](std::size_t a, std::size_t b, std::size_t c, std::size_t d) {
+            return static_cast<double>(sum_in(biome_sums, a, b, c, d));
+        });
+    }
+
+    double site_score_in(int x, int z, int area_width, int area_depth) const noexcept {
+        return sum_over(x, z, area_width, area_depth, [this](std::size_t a, std::size_t b, std::size_t c, std::size_t d) {
+            return static_cast<double>(sum_in(site_sums, a, b, c, d));
+        });
+    }
+
+    double score_in(int x, int z, int area_width, int area_depth) const noexcept {
+        return biome_score_in(x, z, area_width, area_depth) + site_score_in(x, z, area_width, area_depth);
+    }
+
+    // Chunks [chunk_x, chunk_x + chunk_count_x) x [chunk_z, chunk_z + chunk_count_z)
+    double chunk_score(int chunk_x, int chunk_z, int chunk_count_x = 1, int chunk_count_z = 1) const noexcept {
+        return score_in(chunk_x * static_cast<int>(world::CHUNK_WIDTH), chunk_z * static_cast<int>(world::CHUNK_DEPTH),
+                        chunk_count_x * static_cast<int>(world::CHUNK_WIDTH), chunk_count_z * static_cast<int>(world::CHUNK_DEPTH));
+    }
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_SCORE_TABLE_HPP
@@ -0,0 +1,225 @@
+#include "site_index.hpp"
+#include "world.hpp"
+
+static_assert(site_index::CHUNK_SIZE == world::CHUNK_WIDTH && site_index::CHUNK_SIZE == world::CHUNK_DEPTH, "chunks must be square");
+static_assert(site_index::CHUNK_SIZE * site_index::CHUNK_SIZE <= 65536, "the tiles of a chunk must fit in 16 bits");
+
+void site_index::resize(int new_width, int new_depth) {
+    std::vector<chunk_sites> resized(static_cast<std::size_t>(new_width) * new_depth);
+    for(int z = 0; z < depth; ++z) {
+        std::move(chunks.begin() + z * width, chunks.begin() + (z + 1) * width, resized.begin() + z * new_width);
+    }
+
+    chunks = std::move(resized);
+    width = new_width;
+    depth = new_depth;
+}
+
+const site_index::chunk_sites* site_index::chunk_at(int chunk_x, int chunk_z) const noexcept {
+    if(chunk_x < 0 || chunk_z < 0 || chunk_x >= width || chunk_z >= depth) {
+        return nullptr;
+    }
+
+    return &chunks[chunk_z * width + chunk_x];
+}
+
+site_index::chunk_sites* site_index::chunk_at(int chunk_x, int chunk_z) noexcept {
+    if(chunk_x < 0 || chunk_z < 0 || chunk_x >= width || chunk_z >= depth) {
+        return nullptr;
+    }
+
+    return &chunks[chunk_z * width + chunk_x];
+}
+
+glm::i32vec2 site_index::chunk_of(int x, int z) noexcept {
+    return glm::i32vec2(x / CHUNK_SIZE, z / CHUNK_SIZE);
+}
+
+site_index::tile_type site_index::local_tile(int x, int z) noexcept {
+    return static_cast<tile_type>(z * CHUNK_SIZE + x);
+}
+
+glm::i32vec2 site_index::world_tile(int chunk_x, int chunk_z, tile_type tile) noexcept {
+    return glm::i32vec2(chunk_x * CHUNK_SIZE + tile % CHUNK_SIZE, chunk_z * CHUNK_SIZE + tile / CHUNK_SIZE);
+}
+
+float site_index::chunk_distance_sq(glm::vec2 position, int chunk_x, int chunk_z) noexcept {
+    const float dx = std::max(std::max(chunk_x * CHUNK_SIZE - position.x, position.x - (chunk_x + 1) * CHUNK_SIZE), 0.f);
+    const float dz = std::max(std::max(chunk_z * CHUNK_SIZE - position.y, position.y - (chunk_z + 1) * CHUNK_SIZE), 0.f);
+    return dx * dx + dz * dz;
+}
+
+void site_index::update(const world_chunk& chunk) {
+    const world_chunk::position_type pos = chunk.position();
+    if(pos.x < 0 || pos.y < 0) {
+        return;
+    }
+
+    if(pos.x >= width || pos.y >= depth) {
+        resize(std::max(width, pos.x + 1), std::max(depth, pos.y + 1));
+    }
+
+    // Sites of a tile may repeat a type, the tile is kept once
+    std::array<std::vector<tile_type>, SITE_COUNT> tiles_by_type;
+    chunk.for_each_site([&tiles_by_type](const glm::i32vec3& position, const site& s) {
+        if(s.type() > SITE_NOTHING && s.type() < SITE_COUNT && !s.is_depleted()) {
+            tiles_by_type[s.type()].push_back(local_tile(position.x, position.z));
+        }
+    });
+
+    chunk_sites& sites = chunks[pos.y * width + pos.x];
+    sites.types = 0;
+    sites.tiles.clear();
+    for(int type = 0; type < SITE_COUNT; ++type) {
+        std::vector<tile_type>& tiles = tiles_by_type[type];
+        std::sort(tiles.begin(), tiles.end());
+        tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+        sites.type_starts[type] = static_cast<uint16_t>(sites.tiles.size());
+        sites.tiles.insert(sites.tiles.end(), tiles.begin(), tiles.end());
+        if(!tiles.empty()) {
+            sites.types |= type_mask{1} << type;
+        }
+    }
+    sites.type_starts[SITE_COUNT] = static_cast<uint16_t>(sites.tiles.size());
+}
+
+void site_index::remove(site::id type, int x, int z) {
+    if(type < 0 || type >= SITE_COUNT || x < 0 || z < 0) {
+        return;
+    }
+
+    const glm::i32vec2 chunk = chunk_of(x, z);
+    chunk_sites* sites = chunk_at(chunk.x, chunk.y);
+    if(!sites) {
+        return;
+    }
+
+    const auto first = sites->tiles.begin() + sites->type_starts[type];
+    const auto last = sites->tiles.begin() + sites->type_starts[type + 1];
+    const tile_type tile = local_tile(x - chunk.x * CHUNK_SIZE, z - chunk.y * CHUNK_SIZE);
+    const auto it = std::lower_bound(first, last, tile);
+    if(it == last || *it != tile) {
+        return;
+    }
+
+    sites->tiles.erase(it);
+    for(int next_type = type + 1; next_type <= SITE_COUNT; ++next_type) {
+        --sites->type_starts[next_type];
+    }
+
+    if(sites->type_starts[type] == sites->type_starts[type + 1]) {
+        sites->types &= ~(type_mask{1} << type);
+    }
+}
+
+bool site_index::contains(site::id type, int x, int z) const noexcept {
+    if(type < 0 || type >= SITE_COUNT || x < 0 || z < 0) {
+        return false;
+    }
+
+    const glm::i32vec2 chunk = chunk_of(x, z);
+    const chunk_sites* sites = chunk_at(chunk.x, chunk.y);
+    if(!sites || (sites->types & (type_mask{1} << type)) == 0) {
+        return false;
+    }
+
+    return std::binary_search(sites->tiles.begin() + sites->type_starts[type],
+                              sites->tiles.begin() + sites->type_starts[type + 1],
+                              local_tile(x - chunk.x * CHUNK_SIZE, z - chunk.y * CHUNK_SIZE));
+}
+
+site_index::type_mask site_index::types_in(int chunk_x, int chunk_z) const noexcept {
+    const chunk_sites* sites = chunk_at(chunk_x, chunk_z);
+    return sites ? sites->types : 0;
+}
+
+std::size_t site_index::nearest(site::id type, glm::vec2 position, float radius, std::size_t count, std::vector<glm::i32vec2>& tiles) const {
+    tiles.clear();
+    if(type < 0 || type >= SITE_COUNT || count == 0 || chunks.empty()) {
+        return 0;
+    }
+
+    std::vector<float> distances_sq;
+    distances_sq.reserve(count);
+    tiles.reserve(count);
+
+    const float radius_sq = radius * radius;
+    const type_mask type_bit = type_mask{1} << type;
+    auto visit = [&](glm::i32vec2 tile) {
+        const glm::vec2 diff = glm::vec2(tile.x + 0.5f, tile.y + 0.5f) - position;
+        const float distance_sq = diff.x * diff.x + diff.y * diff.y;
+        if(distance_sq > radius_sq || (tiles.size() == count && distance_sq >= distances_sq.back())) {
+            return;
+        }
+
+        // Insertion in the sorted list of tiles
+        if(tiles.size() < count) {
+            tiles.push_back(tile);
+            distances_sq.push_back(distance_sq);
+        }
+
+        std::size_t i = tiles.size() - 1;
+        while(i > 0 && distances_sq[i - 1] > distance_sq) {
+            distances_sq[i] = distances_sq[i - 1];
+            tiles[i] = tiles[i - 1];
+            --i;
+        }
+        distances_sq[i] = distance_sq;
+        tiles[i] = tile;
+    };
+
+    // Chunks without the type, farther than the radius or than the last tile kept are skipped
+    auto visit_chunk = [&](int chunk_x, int chunk_z) {
+        const chunk_sites* sites = chunk_at(chunk_x, chunk_z);
+        if(!sites || (sites->types & type_bit) == 0) {
+            return;
+        }
+
+        const float distance_sq = chunk_distance_sq(position, chunk_x, chunk_z);
+        if(distance_sq <= radius_sq && (tiles.size() < count || distance_sq < distances_sq.back())) {
+            for_each_tile_in_rows(*sites, type, chunk_x, chunk_z, 0, CHUNK_SIZE - 1, visit);
+        }
+    };
+
+    const int center_x = std::min(std::max(static_cast<int>(std::floor(position.x / CHUNK_SIZE)), 0), width - 1);
+    const int center_z = std::min(std::max(static_cast<int>(std::floor(position.y / CHUNK_SIZE)), 0), depth - 1);
+    const int max_ring = std::max(std::max(center_x, width - 1 - center_x), std::max(center_z, depth - 1 - center_z));
+
+    for(int ring = 0; ring <= max_ring; ++ring) {
+        // Distance to the block of chunks already visited, every tile of this ring is at least this far
+        const float ring_distance = ring == 0 ? 0.f : std::min(std::min(position.x - (center_x - ring + 1) * CHUNK_SIZE,
+                                                                        (center_x + ring) * CHUNK_SIZE - position.x),
+                                                               std::min(position.y - (center_z - ring + 1) * CHUNK_SIZE,
+                                                                        (center_z + ring) * CHUNK_SIZE - position.y));
+        if(ring_distance > radius || (tiles.size() == count && ring_distance * ring_distance >= distances_sq.back())) {
+            break;
+        }
+
+        if(ring == 0) {
+            visit_chunk(center_x, center_z);
+            continue;
+        }
+
+        for(int x = center_x - ring; x <= center_x + ring; ++x) {
+            visit_chunk(x, center_z - ring);
+            visit_chunk(x, center_z + ring);
+        }
+
+        for(int z = center_z - ring + 1; z <= center_z + ring - 1; ++z) {
+            visit_chunk(center_x - ring, z);
+            visit_chunk(center_x + ring, z);
+        }
+    }
+
+    return tiles.size();
+}
+
+std::size_t site_index::memory_usage() const noexcept {
+    std::size_t bytes = chunks.capacity() * sizeof(chunk_sites);
+    for(const chunk_sites& sites : chunks) {
+        bytes += sites.tiles.capacity() * sizeof(tile_type);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,123 @@
+#ifndef MMAP_DEMO_SITE_INDEX_HPP
+#define MMAP_DEMO_SITE_INDEX_HPP
+
+#include "world_chunk.hpp"
+#include "site.hpp"
+#include "constants.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Tiles holding a site that is not depleted, grouped by site type in every chunk.
+// A mask of the types found in a chunk lets the queries skip whole chunks
+class site_index {
+public:
+    using type_mask = uint32_t;
+    using tile_type = uint16_t;
+
+    static_assert(SITE_COUNT <= 32, "the site types must fit in the mask");
+
+    // Tiles on each side of a chunk, checked against the world in the implementation
+    static constexpr int CHUNK_SIZE = 32;
+private:
+    struct chunk_sites {
+        type_mask types = 0;
+
+        // Tiles of type t are in [type_starts[t], type_starts[t + 1]), sorted by z then x
+        std::array<uint16_t, SITE_COUNT + 1> type_starts{};
+        std::vector<tile_type> tiles;
+    };
+
+    // In chunks
+    int width = 0;
+    int depth = 0;
+    std::vector<chunk_sites> chunks;
+
+    void resize(int new_width, int new_depth);
+
+    const chunk_sites* chunk_at(int chunk_x, int chunk_z) const noexcept;
+    chunk_sites* chunk_at(int chunk_x, int chunk_z) noexcept;
+
+    static glm::i32vec2 chunk_of(int x, int z) noexcept;
+    static tile_type local_tile(int x, int z) noexcept;
+    static glm::i32vec2 world_tile(int chunk_x, int chunk_z, tile_type tile) noexcept;
+
+    // Squared distance between a point and the closest point of a chunk
+    static float chunk_distance_sq(glm::vec2 position, int chunk_x, int chunk_z) noexcept;
+
+    template<typename Fn>
+    void for_each_tile_in_rows(const chunk_sites& sites, site::id type, int chunk_x, int chunk_z, int first_z, int last_z, Fn& fn) const {
+        const auto first = sites.tiles.begin() + sites.type_starts[type];
+        const auto last = sites.tiles.begin() + sites.type_starts[type + 1];
+
+        // Tiles are sorted by row, only the rows crossed by the query are read
+        const auto begin = std::lower_bound(first, last, local_tile(0, first_z));
+        const auto end = std::lower_bound(begin, last, local_tile(0, last_z + 1));
+        for(auto it = begin; it != end; ++it) {
+            fn(world_tile(chunk_x, chunk_z, *it));
+        }
+    }
+
+public:
+    // Rewrites the sites of this chunk
+    void update(const world_chunk& chunk);
+
+    // Removes a tile once its last site of this type is depleted
+    void remove(site::id type, int x, int z);
+
+    bool contains(site::id type, int x, int z) const noexcept;
+
+    // Types with at least one site in the chunk
+    type_mask types_in(int chunk_x, int chunk_z) const noexcept;
+
+    // Calls fn(tile) for every tile holding the type whose center is within radius of position
+    template<typename Fn>
+    void for_each_in_radius(site::id type, glm::vec2 position, float radius, Fn fn) const {
+        if(type < 0 || type >= SITE_COUNT) {
+            return;
+        }
+
+        const float radius_sq = radius * radius;
+        auto visit = [&fn, position, radius_sq](glm::i32vec2 tile) {
+            const glm::vec2 diff = glm::vec2(tile.x + 0.5f, tile.y + 0.5f) - position;
+            if(diff.x * diff.x + diff.y * diff.y <= radius_sq) {
+                fn(tile);
+            }
+        };
+
+        const int min_x = std::max(static_cast<int>(std::floor(position.x - radius)), 0);
+        const int min_z = std::max(static_cast<int>(std::floor(position.y - radius)), 0);
+        const int max_x = static_cast<int>(std::floor(position.x + radius));
+        const int max_z = static_cast<int>(std::floor(position.y + radius));
+        if(max_x < min_x || max_z < min_z) {
+            return;
+        }
+
+        const glm::i32vec2 min_chunk = chunk_of(min_x, min_z);
+        const glm::i32vec2 max_chunk = glm::min(chunk_of(max_x, max_z), glm::i32vec2(width - 1, depth - 1));
+        for(int chunk_z = min_chunk.y; chunk_z <= max_chunk.y; ++chunk_z) {
+            for(int chunk_x = min_chunk.x; chunk_x <= max_chunk.x; ++chunk_x) {
+                const chunk_sites* sites = chunk_at(chunk_x, chunk_z);
+                if(!sites || (sites->types & (type_mask{1} << type)) == 0 || chunk_distance_sq(position, chunk_x, chunk_z) > radius_sq) {
+                    continue;
+                }
+
+                const int first_z = std::max(min_z - chunk_z * CHUNK_SIZE, 0);
+                const int last_z = std::min(max_z - chunk_z * CHUNK_SIZE, CHUNK_SIZE - 1);
+                for_each_tile_in_rows(*sites, type, chunk_x, chunk_z, first_z, last_z, visit);
+            }
+        }
+    }
+
+    // Writes at most count tiles sorted by distance, chunks are visited in rings around the
+    // position and the search stops once the next ring is farther than the last tile kept
+    std::size_t nearest(site::id type, glm::vec2 position, float radius, std::size_t count, std::vector<glm::i32vec2>& tiles) const;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_SITE_INDEX_HPP
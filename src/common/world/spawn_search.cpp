@@ -0,0 +1,64 @@
+#include "spawn_search.hpp"
+
+#include <tuple>
+
+spawn_grid::spawn_grid(glm::i32vec2 size)
+: size{size}
+, blocked(static_cast<std::size_t>(size.x) * size.y, false) {
+
+}
+
+void spawn_grid::clear() {
+    std::fill(std::begin(blocked), std::end(blocked), false);
+}
+
+void spawn_grid::block_around(glm::i32vec2 chunk) {
+    for(int z = std::max(chunk.y - MIN_SPAWN_DISTANCE, 0); z <= std::min(chunk.y + MIN_SPAWN_DISTANCE, size.y - 1); ++z) {
+        for(int x = std::max(chunk.x - MIN_SPAWN_DISTANCE, 0); x <= std::min(chunk.x + MIN_SPAWN_DISTANCE, size.x - 1); ++x) {
+            const int dx = x - chunk.x;
+            const int dz = z - chunk.y;
+            if(dx * dx + dz * dz <= MIN_SPAWN_DISTANCE * MIN_SPAWN_DISTANCE) {
+                blocked[static_cast<std::size_t>(z) * size.x + x] = true;
+            }
+        }
+    }
+}
+
+std::vector<spawn_region> rank_spawn_regions(const world& w, const score_table& scores) {
+    const glm::i32vec2 size = w.size();
+
+    // The table clips the regions on the borders, the missing chunks count for nothing
+    std::vector<spawn_region> regions;
+    for(int z = 0; z < size.y; ++z) {
+        for(int x = 0; x < size.x; ++x) {
+            if(w.has_chunk(x, z)) {
+                regions.push_back(spawn_region{glm::i32vec2(x, z), scores.chunk_score(x - 1, z - 1, 3, 3)});
+            }
+        }
+    }
+
+    std::sort(std::begin(regions), std::end(regions), [](const spawn_region& a, const spawn_region& b) {
+        return std::make_tuple(-a.score, a.chunk.x, a.chunk.y) < std::make_tuple(-b.score, b.chunk.x, b.chunk.y);
+    });
+
+    return regions;
+}
+
+std::vector<glm::i32vec2> fallback_spawn_chunks(const world& w, std::size_t player_count) {
+    const glm::i32vec2 last(std::max(w.size().x - 1, 0), std::max(w.size().y - 1, 0));
+    const glm::i32vec2 corners[] = {glm::i32vec2(0, 0), last, glm::i32vec2(last.x, 0), glm::i32vec2(0, last.y)};
+
+    std::vector<glm::i32vec2> spawns;
+    for(std::size_t player = 0; player < player_count; ++player) {
+        if(player < 4) {
+            spawns.push_back(corners[player]);
+        }
+        else {
+            // Shared once the world has fewer chunks than players
+            const int chunk = static_cast<int>(player % ((last.x + 1) * (last.y + 1)));
+            spawns.emplace_back(chunk % (last.x + 1), chunk / (last.x + 1));
+        }
+    }
+
+    return spawns;
+}
@@ -0,0 +1,113 @@
+#ifndef MMAP_DEMO_SPAWN_SEARCH_HPP
+#define MMAP_DEMO_SPAWN_SEARCH_HPP
+
+#include "world.hpp"
+#include "score_table.hpp"
+#include "../async/task.hpp"
+#include "../async/task_executor.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Players must be separated by more than this distance, in chunks
+const int MIN_SPAWN_DISTANCE = 10;
+
+// A chunk and its neighbours
+struct spawn_region {
+    glm::i32vec2 chunk;
+    double score;
+};
+
+// Chunks too close to a chosen spawn, stamped on a grid as large as the world
+class spawn_grid {
+    glm::i32vec2 size;
+    std::vector<bool> blocked;
+public:
+    explicit spawn_grid(glm::i32vec2 size);
+
+    void clear();
+    void block_around(glm::i32vec2 chunk);
+
+    bool is_blocked(glm::i32vec2 chunk) const noexcept {
+        return blocked[static_cast<std::size_t>(chunk.y) * size.x + chunk.x];
+    }
+};
+
+// Regions of every chunk of [0, size), best first with ties broken by position
+std::vector<spawn_region> rank_spawn_regions(const world& w, const score_table& scores);
+
+// Spawns spread over the corners then the chunks of the world, when the players can not be kept apart
+std::vector<glm::i32vec2> fallback_spawn_chunks(const world& w, std::size_t player_count);
+
+// Chunks where the players start. The first player takes the best region, each other one the
+// region whose score is the closest to it among the regions far enough from every chosen spawn.
+// The candidates of each pick are split in band_count bands reduced by tasks forwarded to push,
+// the result only depends on the world
+template<typename TaskPusher>
+std::vector<glm::i32vec2> choose_spawn_chunks(const world& w, const score_table& scores, std::size_t player_count,
+                                              std::size_t band_count, TaskPusher push) {
+    // Anchors past these are not tried, the players most likely do not fit on the map
+    const std::size_t MAX_ANCHOR_COUNT = 16;
+    const std::size_t NONE = static_cast<std::size_t>(-1);
+
+    const std::vector<spawn_region> regions = rank_spawn_regions(w, scores);
+    const std::size_t bands = std::max<std::size_t>(1, std::min(band_count, regions.size()));
+    spawn_grid grid(w.size());
+
+    std::vector<glm::i32vec2> spawns;
+    for(std::size_t anchor = 0; anchor < std::min(regions.size(), MAX_ANCHOR_COUNT) && player_count > 0; ++anchor) {
+        const double anchor_score = regions[anchor].score;
+        spawns.assign(1, regions[anchor].chunk);
+        grid.clear();
+        grid.block_around(regions[anchor].chunk);
+
+        // The closest score wins, then the earliest region in the ranking
+        auto is_better = [&regions, anchor_score](std::size_t a, std::size_t b) {
+            const double a_gap = std::abs(regions[a].score - anchor_score);
+            const double b_gap = std::abs(regions[b].score - anchor_score);
+            return a_gap < b_gap || (a_gap == b_gap && a < b);
+        };
+
+        while(spawns.size() < player_count) {
+            std::vector<std::size_t> band_best(bands, NONE);
+            std::vector<async::task_executor::task_future> futures;
+            for(std::size_t band = 0; band < bands; ++band) {
+                futures.push_back(push(async::make_task([band, bands, &regions, &grid, &band_best, &is_better]() {
+                    const std::size_t first = regions.size() * band / bands;
+                    const std::size_t last = regions.size() * (band + 1) / bands;
+                    for(std::size_t i = first; i < last; ++i) {
+                        if(!grid.is_blocked(regions[i].chunk) && (band_best[band] == NONE || is_better(i, band_best[band]))) {
+                            band_best[band] = i;
+                        }
+                    }
+                })));
+            }
+
+            std::size_t best = NONE;
+            for(std::size_t band = 0; band < bands; ++band) {
+                futures[band].wait();
+                if(band_best[band] != NONE && (best == NONE || is_better(band_best[band], best))) {
+                    best = band_best[band];
+                }
+            }
+
+            if(best == NONE) {
+                break;
+            }
+
+            spawns.push_back(regions[best].chunk);
+            grid.block_around(regions[best].chunk);
+        }
+
+        if(spawns.size() == player_count) {
+            return spawns;
+        }
+    }
+
+    return fallback_spawn_chunks(w, player_count);
+}
+
+#endif //MMAP_DEMO_SPAWN_SEARCH_HPP
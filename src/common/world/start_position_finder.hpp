@@ -4,7 +4,7 @@
 #include "world.hpp"
 #include "world_generator.hpp"
 
-#include "glm\glm.hpp"
+#include <glm/glm.hpp>
 
 #include <vector>
 #include <array>
@@ -34,9 +34,9 @@ std::unordered_map<int, int> site_value{ {
     { SITE_MAGIC_ESSENCE, 5 },
     { SITE_NOTHING, 0 },
     { SITE_STONE , 5 },
-    { SITE_TREE, 1 } } }
+    { SITE_TREE, 1 } } };
 
-std::vector<chunk_value> get_all_chunk_value(world* world_map)
+inline std::vector<chunk_value> get_all_chunk_value(world* world_map)
 {
     std::vector<chunk_value> chunk_values;
     chunk_values.reserve(std::distance(world_map->begin(), world_map->end()));
@@ -46,7 +46,7 @@ std::vector<chunk_value> get_all_chunk_value(world* world_map)
         int total_value = 0;
         for (uint32_t x = 0; x < world_map->CHUNK_WIDTH; ++x)
         {
-            for (uint32_t y = 0; y < world_map->CHUNK_DEPTH; ++x)
+            for (uint32_t y = 0; y < world_map->CHUNK_DEPTH; ++y)
             {
                 total_value += site_value[i->biome_at(x, 0, y)];
             }
@@ -62,61 +62,21 @@ class start_position_finder
     world* world_map;
     std::unordered_map<int, int> site_value;
 
-    bool position_is_free(uint32_t x, uint32_t y, world_chunk* chunk)
+    // Nothing stands on the tile: no water, site or building
+    bool position_is_free(int x, int z) const
     {
-        int biome = chunk->biome_at(x, 0, y);
-        auto sites  = chunk->sites_at(x, 0, y);
-
-        if (biome != BIOME_WATER || sites.size() > 1 || sites.front()->type() != SITE_NOTHING)
-        {
-            return false;
-        }
-        return true;
+        return !world_map->occupancy().is_occupied(x, z);
     }
 
-    std::vector<glm::i32vec2> get_all_x_by_y_free_space(uint32_t x, uint32_t y, world_chunk* chunk)
+    // Top left corners, in tiles of the world, of every x by y area of the chunk where nothing stands
+    std::vector<glm::i32vec2> get_all_x_by_y_free_space(uint32_t x, uint32_t y, const world_chunk* chunk) const
     {
-        const uint32_t width = world_map->CHUNK_WIDTH;
-        const uint32_t height = world_map->CHUNK_DEPTH;
-        std::vector<glm::i32vec2> free;
-
-        std::array<std::array<bool, height>, width> available;
-
-        for (uint32_t i = 0; i < world_map->CHUNK_WIDTH; ++i)
-        {
-            for (uint32_t j = 0; j < world_map->CHUNK_DEPTH; ++j)
-            {
-                available[i][j] = position_is_free(i,j, chunk);
-            }
-        }
-
-        for (uint32_t i = 0; i < world_map->CHUNK_WIDTH - x; ++i)
-        {
-            for (uint32_t j = 0; j < world_map->CHUNK_DEPTH - y; ++j)
-            {
-                bool is_free = true;
-                for (uint32_t _x = i; _x < i + x; ++_x)
-                {
-                    for (uint32_t _y = j; _y < j + y; ++_y)
-                    {
-                        if (!available[_x][_y])
-                        {
-                            is_free = false;
-                        }
-                    }
-                }
-                if (is_free)
-                {
-                    free.emplace_back(i, j);
-                }
-            }
-        }
-        return free;
+        return world_map->occupancy().free_spots_in(chunk->position().x, chunk->position().y, static_cast<int>(x), static_cast<int>(y));
     }
 
     std::optional<glm::i32vec2> get_one_random_free_position(int width, int height, world_chunk* chunk, std::default_random_engine& engine )
     {
-        auto &free_pos = get_all_x_by_y_free_space(width, height, chunk);
+        auto free_pos = get_all_x_by_y_free_space(width, height, chunk);
         if (free_pos.empty())
         {
             return std::nullopt;
@@ -129,8 +89,7 @@ class start_position_finder
     
 public:
     start_position_finder(world* world_map) :
-        world_map{world_map},
-        
+        world_map{world_map}
     {
     }
 
@@ -165,7 +124,7 @@ public:
     }
     void create_pleyers_start_position(uint32_t seed)
     {
-        std::vector<world_chunk> available_chunk;
+        std::vector<const world_chunk*> available_chunk;
         available_chunk.reserve(distance(world_map->begin(), world_map->end()));
 
         auto is_enough = 3 * ((world_map->CHUNK_DEPTH * world_map->CHUNK_WIDTH) / 4);
@@ -175,7 +134,7 @@ public:
             auto free_space_for_building = get_all_x_by_y_free_space(4, 4, &(*it));
             if (nb > is_enough && !free_space_for_building.empty())
             {
-                available_chunk.push_back(*it);
+                available_chunk.push_back(&(*it));
             }
         }
 
@@ -190,11 +149,11 @@ public:
         {
             for (auto it_ = it + 1; it_ < available_chunk.end(); ++it_)
             {
-                int distance = manhattan_distance(it->position(), it_->position());
+                int distance = manhattan_distance((*it)->position(), (*it_)->position());
                 if (distance > minimum_distance)
                 {
-                    player1_chunk_position = it->position();
-                    player2_chunk_position = it_->position();
+                    player1_chunk_position = (*it)->position();
+                    player2_chunk_position = (*it_)->position();
                 }
             }
         }
@@ -0,0 +1,64 @@
+#ifndef MMAP_DEMO_TILE_TRACE_HPP
+#define MMAP_DEMO_TILE_TRACE_HPP
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+// First tile refused along a segment
+struct tile_trace {
+    bool is_blocked = false;
+    glm::i32vec2 tile{0, 0};
+
+    // Part of the segment travelled before entering the tile, in [0, 1]
+    float entry = 1.f;
+};
+
+// Visits the tiles crossed by the segment in order (Amanatides & Woo) and stops at the
+// first one refused by is_walkable(x, z). The tile of the start is never tested
+template<typename WalkablePredicate>
+tile_trace trace_tiles(glm::vec2 from, glm::vec2 to, WalkablePredicate is_walkable) {
+    tile_trace trace;
+
+    glm::i32vec2 tile(static_cast<int>(std::floor(from.x)), static_cast<int>(std::floor(from.y)));
+    const glm::i32vec2 last(static_cast<int>(std::floor(to.x)), static_cast<int>(std::floor(to.y)));
+    const glm::vec2 direction = to - from;
+
+    const float INFINITE = std::numeric_limits<float>::infinity();
+    const int step_x = direction.x > 0.f ? 1 : -1;
+    const int step_z = direction.y > 0.f ? 1 : -1;
+
+    // Part of the segment needed to cross the next vertical and horizontal tile borders
+    float next_x = direction.x != 0.f ? ((tile.x + (step_x > 0 ? 1 : 0)) - from.x) / direction.x : INFINITE;
+    float next_z = direction.y != 0.f ? ((tile.y + (step_z > 0 ? 1 : 0)) - from.y) / direction.y : INFINITE;
+    const float delta_x = direction.x != 0.f ? std::abs(1.f / direction.x) : INFINITE;
+    const float delta_z = direction.y != 0.f ? std::abs(1.f / direction.y) : INFINITE;
+
+    // Rounding can not make the walk longer than the tiles between both ends
+    int remaining = std::abs(last.x - tile.x) + std::abs(last.y - tile.y);
+    while(remaining-- > 0) {
+        float entry;
+        if(next_x < next_z) {
+            tile.x += step_x;
+            entry = next_x;
+            next_x += delta_x;
+        }
+        else {
+            tile.y += step_z;
+            entry = next_z;
+            next_z += delta_z;
+        }
+
+        if(!is_walkable(tile.x, tile.y)) {
+            trace.is_blocked = true;
+            trace.tile = tile;
+            trace.entry = std::min(std::max(entry, 0.f), 1.f);
+            return trace;
+        }
+    }
+
+    return trace;
+}
+
+#endif //MMAP_DEMO_TILE_TRACE_HPP
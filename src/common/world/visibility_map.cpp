@@ -1,43 +1,162 @@
 #include "visibility_map.hpp"
+#include "world.hpp"
 
 #include <algorithm>
-#include <iterator>
+#include <cassert>
+#include <utility>
+
+static_assert(visibility_map::CHUNK_SIZE == world::CHUNK_WIDTH && visibility_map::CHUNK_SIZE == world::CHUNK_DEPTH, "chunks must be square");
+static_assert(visibility_map::WORD_BITS % visibility_map::CHUNK_SIZE == 0, "a chunk row must fit in a single word");
 
 visibility_map::visibility_map(std::size_t width, std::size_t height)
 : width_(width)
-, height_(height) {
+, height_(height)
+, stride((width + WORD_BITS - 1) / WORD_BITS)
+, chunk_stride(((width + CHUNK_SIZE - 1) / CHUNK_SIZE + WORD_BITS - 1) / WORD_BITS) {
     // At first each tile is unexplored
-    tile_visibility.resize(height);
-    for(std::size_t y = 0; y < height; ++y) {
-        tile_visibility[y].resize(width, visibility::unexplored);
+    visible_tiles.assign(stride * height, 0);
+    explored_tiles.assign(stride * height, 0);
+
+    const std::size_t chunk_height = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    visible_chunks.assign(chunk_stride * chunk_height, 0);
+    stale_chunks.assign(chunk_stride * chunk_height, 0);
+}
+
+void visibility_map::mark_chunks(std::vector<word_type>& chunks, std::size_t y, std::size_t first, std::size_t last) noexcept {
+    const std::size_t row = y / CHUNK_SIZE * chunk_stride;
+    for(std::size_t chunk = first / CHUNK_SIZE; chunk <= last / CHUNK_SIZE; ++chunk) {
+        chunks[row + chunk / WORD_BITS] |= word_type{1} << (chunk % WORD_BITS);
     }
 }
 
 void visibility_map::clear(bool complete) noexcept {
-    std::for_each(std::begin(tile_visibility), std::end(tile_visibility), [complete](std::vector<visibility>& row) {
-        if(complete) {
-            std::transform(std::begin(row), std::end(row), std::begin(row), [](visibility v) {
-                return visibility::unexplored;
-            });
+    if(complete) {
+        std::fill(std::begin(explored_tiles), std::end(explored_tiles), 0);
+    }
+    else {
+        for(std::size_t i = 0; i < explored_tiles.size(); ++i) {
+            explored_tiles[i] |= visible_tiles[i];
         }
-        else {
-            std::transform(std::begin(row), std::end(row), std::begin(row), [](visibility v) {
-                if(v == visibility::visible) {
-                    return visibility::explored;
+    }
+
+    std::fill(std::begin(visible_tiles), std::end(visible_tiles), 0);
+    std::fill(std::begin(visible_chunks), std::end(visible_chunks), 0);
+    std::fill(std::begin(stale_chunks), std::end(stale_chunks), 0);
+}
+
+void visibility_map::advance_from(const visibility_map& previous) noexcept {
+    assert(previous.width_ == width_ && previous.height_ == height_);
+
+    for(std::size_t i = 0; i < explored_tiles.size(); ++i) {
+        explored_tiles[i] = previous.explored_tiles[i] | previous.visible_tiles[i];
+    }
+
+    std::fill(std::begin(visible_tiles), std::end(visible_tiles), 0);
+    std::fill(std::begin(visible_chunks), std::end(visible_chunks), 0);
+    std::fill(std::begin(stale_chunks), std::end(stale_chunks), 0);
+}
+
+void visibility_map::merge(const visibility_map& other) noexcept {
+    assert(other.width_ == width_ && other.height_ == height_);
+
+    for(std::size_t i = 0; i < visible_tiles.size(); ++i) {
+        visible_tiles[i] |= other.visible_tiles[i];
+        explored_tiles[i] |= other.explored_tiles[i];
+    }
+
+    // A chunk stale in the other map may still be visible here
+    for(std::size_t i = 0; i < visible_chunks.size(); ++i) {
+        visible_chunks[i] |= other.visible_chunks[i];
+        stale_chunks[i] |= other.stale_chunks[i];
+    }
+}
+
+void visibility_map::reveal_span(std::size_t y, std::size_t first, std::size_t last) noexcept {
+    for(std::size_t x = first; x <= last; x = x - x % WORD_BITS + WORD_BITS) {
+        visible_tiles[word_of(x, y)] |= span_bits(x, first, last);
+    }
+
+    mark_chunks(visible_chunks, y, first, last);
+}
+
+void visibility_map::reveal(const visibility_stencil& stencil, glm::i32vec2 tile) noexcept {
+    stencil.for_each_span(tile, static_cast<int>(width_), static_cast<int>(height_), [this](int y, int first, int last) {
+        reveal_span(y, first, last);
+    });
+}
+
+void visibility_map::copy_span(const visibility_map& other, std::size_t y, std::size_t first, std::size_t last) noexcept {
+    assert(other.width_ == width_ && other.height_ == height_);
+
+    const std::size_t first_word = word_of(first, y);
+    const std::size_t last_word = word_of(last, y);
+    std::copy(other.visible_tiles.begin() + first_word, other.visible_tiles.begin() + last_word + 1, visible_tiles.begin() + first_word);
+    std::copy(other.explored_tiles.begin() + first_word, other.explored_tiles.begin() + last_word + 1, explored_tiles.begin() + first_word);
+
+    // The copied words may hold tiles outside of the span
+    const std::size_t first_tile = first - first % WORD_BITS;
+    const std::size_t last_tile = std::min(last - last % WORD_BITS + WORD_BITS - 1, width_ - 1);
+    mark_chunks(stale_chunks, y, first_tile, last_tile);
+}
+
+void visibility_map::refresh_chunks() noexcept {
+    const std::size_t chunk_height = (height_ + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for(std::size_t chunk_y = 0; chunk_y < chunk_height; ++chunk_y) {
+        for(std::size_t word = 0; word < chunk_stride; ++word) {
+            word_type& stale = stale_chunks[chunk_y * chunk_stride + word];
+            for(; stale != 0; stale &= stale - 1) {
+                std::size_t chunk_x = word * WORD_BITS;
+                while(((stale >> (chunk_x % WORD_BITS)) & 1) == 0) {
+                    ++chunk_x;
+                }
+
+                const std::size_t first_x = chunk_x * CHUNK_SIZE;
+                const word_type chunk_mask = ((word_type{1} << CHUNK_SIZE) - 1) << (first_x % WORD_BITS);
+                const std::size_t end_y = std::min((chunk_y + 1) * CHUNK_SIZE, height_);
+
+                word_type any_visible = 0;
+                for(std::size_t y = chunk_y * CHUNK_SIZE; y < end_y; ++y) {
+                    any_visible |= visible_tiles[word_of(first_x, y)] & chunk_mask;
                 }
 
-                return v;
-            });
+                const word_type bit = word_type{1} << (chunk_x % WORD_BITS);
+                word_type& visible = visible_chunks[chunk_y * chunk_stride + word];
+                visible = any_visible != 0 ? visible | bit : visible & ~bit;
+            }
         }
-    });
+    }
 }
 
 visibility visibility_map::at(std::size_t x, std::size_t y) const noexcept {
-    return tile_visibility[y][x];
+    const std::size_t word = word_of(x, y);
+    const word_type bit = word_type{1} << (x % WORD_BITS);
+
+    if(visible_tiles[word] & bit) {
+        return visibility::visible;
+    }
+
+    return (explored_tiles[word] & bit) ? visibility::explored : visibility::unexplored;
 }
 
 void visibility_map::set(std::size_t x, std::size_t y, visibility value) noexcept {
-    tile_visibility[y][x] = value;
+    const std::size_t word = word_of(x, y);
+    const word_type bit = word_type{1} << (x % WORD_BITS);
+
+    visible_tiles[word] = value == visibility::visible ? visible_tiles[word] | bit : visible_tiles[word] & ~bit;
+    explored_tiles[word] = value == visibility::explored ? explored_tiles[word] | bit : explored_tiles[word] & ~bit;
+
+    mark_chunks(value == visibility::visible ? visible_chunks : stale_chunks, y, x, x);
+}
+
+void visibility_map::swap(visibility_map& other) noexcept {
+    std::swap(visible_tiles, other.visible_tiles);
+    std::swap(explored_tiles, other.explored_tiles);
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    std::swap(stride, other.stride);
+    std::swap(visible_chunks, other.visible_chunks);
+    std::swap(stale_chunks, other.stale_chunks);
+    std::swap(chunk_stride, other.chunk_stride);
 }
 
 std::size_t visibility_map::width() const noexcept {
@@ -46,4 +165,9 @@ std::size_t visibility_map::width() const noexcept {
 
 std::size_t visibility_map::height() const noexcept {
     return height_;
-}
\ No newline at end of file
+}
+
+std::size_t visibility_map::memory_usage() const noexcept {
+    return (visible_tiles.capacity() + explored_tiles.capacity()
+          + visible_chunks.capacity() + stale_chunks.capacity()) * sizeof(word_type);
+}
@@ -1,6 +1,10 @@
 #ifndef MMAP_DEMO_VISIBILITY_MAP_HPP
 #define MMAP_DEMO_VISIBILITY_MAP_HPP
 
+#include "visibility_stencil.hpp"
+
+#include <glm/glm.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -10,19 +14,114 @@ enum class visibility : uint8_t {
     visible
 };
 
+// Two packed bit planes, a tile is visible when its bit is set in the first plane
+// and explored when it is set in the second one only.
+// A bit per chunk tells if any of its tiles is visible
 class visibility_map {
-    std::vector<std::vector<visibility>> tile_visibility;
+public:
+    using word_type = uint64_t;
+
+    static constexpr int WORD_BITS = 64;
+
+    // Tiles on each side of a chunk, checked against the world in the implementation
+    static constexpr std::size_t CHUNK_SIZE = 32;
+private:
+    std::vector<word_type> visible_tiles;
+    std::vector<word_type> explored_tiles;
     std::size_t width_ = 0, height_ = 0;
+    std::size_t stride = 0;
+
+    // Chunks whose tiles may have been hidden are recomputed by refresh_chunks()
+    std::vector<word_type> visible_chunks;
+    std::vector<word_type> stale_chunks;
+    std::size_t chunk_stride = 0;
+
+    std::size_t word_of(std::size_t x, std::size_t y) const noexcept {
+        return y * stride + x / WORD_BITS;
+    }
+
+    // Flags the chunks holding the tiles [first, last] of a row
+    void mark_chunks(std::vector<word_type>& chunks, std::size_t y, std::size_t first, std::size_t last) noexcept;
+
+    // Bits of the tiles [first, last] found in the word holding the tile x
+    static word_type span_bits(std::size_t x, std::size_t first, std::size_t last) noexcept {
+        const std::size_t word_start = x - x % WORD_BITS;
+        const std::size_t from = std::max(first, word_start) - word_start;
+        const std::size_t to = std::min(last, word_start + WORD_BITS - 1) - word_start;
+        const word_type high = to == WORD_BITS - 1 ? ~word_type{0} : (word_type{1} << (to + 1)) - 1;
+        return high & (~word_type{0} << from);
+    }
 public:
     visibility_map() = delete;
     visibility_map(std::size_t width, std::size_t height);
 
+    // Visible tiles become explored, every tile becomes unexplored when complete
     void clear(bool complete = false) noexcept;
+
+    // Starts a new frame from the previous one without copying it: its visible tiles
+    // become explored here and nothing is visible yet. Both maps must have the same size
+    void advance_from(const visibility_map& previous) noexcept;
+
+    // Keeps the most revealed state of both maps on every tile, the vision of a team
+    // is the merge of the maps of its players
+    void merge(const visibility_map& other) noexcept;
+
+    // Marks the tiles [first, last] of a row as visible
+    void reveal_span(std::size_t y, std::size_t first, std::size_t last) noexcept;
+
+    // Marks every tile of the stencil centered on this tile as visible
+    void reveal(const visibility_stencil& stencil, glm::i32vec2 tile) noexcept;
+
+    // The tiles [first, last] of a row that are no longer seen(x) become explored
+    template<typename IsSeen>
+    void conceal_span(std::size_t y, std::size_t first, std::size_t last, IsSeen is_seen) noexcept {
+        for(std::size_t x = first; x <= last; x = x - x % WORD_BITS + WORD_BITS) {
+            const std::size_t last_in_word = std::min(last, x - x % WORD_BITS + WORD_BITS - 1);
+
+            word_type hidden = 0;
+            for(std::size_t tile = x; tile <= last_in_word; ++tile) {
+                if(!is_seen(tile)) {
+                    hidden |= word_type{1} << (tile % WORD_BITS);
+                }
+            }
+
+            const std::size_t word = word_of(x, y);
+            explored_tiles[word] |= visible_tiles[word] & hidden;
+            visible_tiles[word] &= ~hidden;
+        }
+
+        mark_chunks(stale_chunks, y, first, last);
+    }
+
+    // Copies both planes on the words covering the tiles [first, last] of a row
+    void copy_span(const visibility_map& other, std::size_t y, std::size_t first, std::size_t last) noexcept;
+
     visibility at(std::size_t x, std::size_t y) const noexcept;
     void set(std::size_t x, std::size_t y, visibility value) noexcept;
 
+    bool is_visible(std::size_t x, std::size_t y) const noexcept {
+        return ((visible_tiles[word_of(x, y)] >> (x % WORD_BITS)) & 1) != 0;
+    }
+
+    // Recomputes the chunks that may have lost their last visible tile since the last call
+    void refresh_chunks() noexcept;
+
+    // Once refreshed, false means that no tile of the chunk is visible
+    bool is_chunk_visible(std::size_t chunk_x, std::size_t chunk_y) const noexcept {
+        const std::size_t chunk_width = (width_ + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if(chunk_x >= chunk_width || chunk_y * chunk_stride >= visible_chunks.size()) {
+            return false;
+        }
+
+        return ((visible_chunks[chunk_y * chunk_stride + chunk_x / WORD_BITS] >> (chunk_x % WORD_BITS)) & 1) != 0;
+    }
+
+    void swap(visibility_map& other) noexcept;
+
     std::size_t width() const noexcept;
     std::size_t height() const noexcept;
+
+    std::size_t memory_usage() const noexcept;
 };
 
 
@@ -0,0 +1,20 @@
+#include "visibility_stencil.hpp"
+
+#include <cmath>
+
+visibility_stencil::visibility_stencil(float radius)
+: rows_radius(radius >= 0.f ? static_cast<int>(std::floor(radius)) : -1) {
+    const float radius_sq = radius * radius;
+    for(int dy = -rows_radius; dy <= rows_radius; ++dy) {
+        half_widths.push_back(static_cast<int>(std::floor(std::sqrt(std::max(radius_sq - dy * dy, 0.f)))));
+    }
+}
+
+std::size_t visibility_stencil::area() const noexcept {
+    std::size_t tiles = 0;
+    for(int half_width : half_widths) {
+        tiles += 2 * half_width + 1;
+    }
+
+    return tiles;
+}
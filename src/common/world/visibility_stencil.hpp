@@ -0,0 +1,53 @@
+#ifndef MMAP_DEMO_VISIBILITY_STENCIL_HPP
+#define MMAP_DEMO_VISIBILITY_STENCIL_HPP
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+// Row spans of the tiles seen from a tile: a tile is seen when the distance
+// between both tile centers is at most the radius
+class visibility_stencil {
+    int rows_radius;
+
+    // Half width of the row dy, stored at dy + rows_radius
+    std::vector<int> half_widths;
+public:
+    explicit visibility_stencil(float radius);
+
+    // Calls fn(y, first_x, last_x) for every row of the disc centered on the tile,
+    // clipped to a map of this size. Both ends of a span are included
+    template<typename Fn>
+    void for_each_span(glm::i32vec2 tile, int width, int height, Fn fn) const {
+        const int first_y = std::max(tile.y - rows_radius, 0);
+        const int last_y = std::min(tile.y + rows_radius, height - 1);
+        for(int y = first_y; y <= last_y; ++y) {
+            int first_x, last_x;
+            if(span_at(tile, y, width, &first_x, &last_x)) {
+                fn(y, first_x, last_x);
+            }
+        }
+    }
+
+    // Clipped span of the row y, false when the disc does not cover the row
+    bool span_at(glm::i32vec2 tile, int y, int width, int* first_x, int* last_x) const noexcept {
+        const int dy = y - tile.y;
+        if(dy < -rows_radius || dy > rows_radius) {
+            return false;
+        }
+
+        const int half_width = half_widths[dy + rows_radius];
+        *first_x = std::max(tile.x - half_width, 0);
+        *last_x = std::min(tile.x + half_width, width - 1);
+        return *first_x <= *last_x;
+    }
+
+    int radius_in_rows() const noexcept {
+        return rows_radius;
+    }
+
+    // Number of tiles in the unclipped disc
+    std::size_t area() const noexcept;
+};
+
+#endif //MMAP_DEMO_VISIBILITY_STENCIL_HPP
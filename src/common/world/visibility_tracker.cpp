@@ -0,0 +1,153 @@
+#include "visibility_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Calls fn(first, last) on the parts of [first, last] outside of [other_first, other_last]
+template<typename Fn>
+void for_each_outside(int first, int last, bool has_other, int other_first, int other_last, Fn fn) {
+    if(!has_other || last < other_first || first > other_last) {
+        fn(first, last);
+        return;
+    }
+
+    if(first < other_first) {
+        fn(first, other_first - 1);
+    }
+
+    if(last > other_last) {
+        fn(other_last + 1, last);
+    }
+}
+
+}
+
+visibility_tracker::visibility_tracker(std::size_t width, std::size_t height)
+: width(static_cast<int>(width))
+, height(static_cast<int>(height))
+, viewer_counts(width * height, 0) {
+
+}
+
+const visibility_stencil& visibility_tracker::stencil_of(float radius) {
+    auto it = stencils.find(radius);
+    if(it == stencils.end()) {
+        it = stencils.emplace(radius, visibility_stencil(radius)).first;
+    }
+
+    return it->second;
+}
+
+void visibility_tracker::see(int y, int first, int last, visibility_map& next) {
+    uint16_t* counts = viewer_counts.data() + y * width;
+    for(int x = first; x <= last; ++x) {
+        ++counts[x];
+    }
+
+    next.reveal_span(y, first, last);
+    changed_spans.push_back(row_span{y, first, last});
+}
+
+void visibility_tracker::unsee(int y, int first, int last, visibility_map& next) {
+    uint16_t* counts = viewer_counts.data() + y * width;
+    for(int x = first; x <= last; ++x) {
+        --counts[x];
+    }
+
+    next.conceal_span(y, first, last, [counts](std::size_t x) {
+        return counts[x] > 0;
+    });
+    changed_spans.push_back(row_span{y, first, last});
+}
+
+void visibility_tracker::add(const stamp& s, visibility_map& next) {
+    s.stencil->for_each_span(s.tile, width, height, [this, &next](int y, int first, int last) {
+        see(y, first, last, next);
+    });
+}
+
+void visibility_tracker::remove(const stamp& s, visibility_map& next) {
+    s.stencil->for_each_span(s.tile, width, height, [this, &next](int y, int first, int last) {
+        unsee(y, first, last, next);
+    });
+}
+
+void visibility_tracker::move(const stamp& from, const stamp& to, visibility_map& next) {
+    const int first_y = std::max(std::min(from.tile.y - from.stencil->radius_in_rows(), to.tile.y - to.stencil->radius_in_rows()), 0);
+    const int last_y = std::min(std::max(from.tile.y + from.stencil->radius_in_rows(), to.tile.y + to.stencil->radius_in_rows()), height - 1);
+
+    for(int y = first_y; y <= last_y; ++y) {
+        int from_first = 0, from_last = -1, to_first = 0, to_last = -1;
+        const bool was_seen = from.stencil->span_at(from.tile, y, width, &from_first, &from_last);
+        const bool is_seen = to.stencil->span_at(to.tile, y, width, &to_first, &to_last);
+
+        // Tiles entering the disc are counted before those leaving it
+        if(is_seen) {
+            for_each_outside(to_first, to_last, was_seen, from_first, from_last, [this, y, &next](int first, int last) {
+                see(y, first, last, next);
+            });
+        }
+
+        if(was_seen) {
+            for_each_outside(from_first, from_last, is_seen, to_first, to_last, [this, y, &next](int first, int last) {
+                unsee(y, first, last, next);
+            });
+        }
+    }
+}
+
+void visibility_tracker::update(const std::vector<viewer>& viewers, const visibility_map& current, visibility_map& next) {
+    ++generation;
+    restamped = 0;
+
+    // Catches up with the last update before applying this one
+    for(const row_span& span : changed_spans) {
+        next.copy_span(current, span.y, span.first, span.last);
+    }
+    changed_spans.clear();
+
+    for(const viewer& v : viewers) {
+        const stamp moved{glm::i32vec2(static_cast<int>(std::floor(v.position.x)), static_cast<int>(std::floor(v.position.y))),
+                          &stencil_of(v.radius), generation};
+
+        auto it = stamps.find(v.id);
+        if(it == stamps.end()) {
+            add(moved, next);
+            stamps.emplace(v.id, moved);
+            ++restamped;
+        }
+        else if(it->second.tile != moved.tile || it->second.stencil != moved.stencil) {
+            move(it->second, moved, next);
+            it->second = moved;
+            ++restamped;
+        }
+        else {
+            it->second.generation = generation;
+        }
+    }
+
+    // Viewers gone since the last update
+    for(auto it = stamps.begin(); it != stamps.end();) {
+        if(it->second.generation != generation) {
+            remove(it->second, next);
+            it = stamps.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    next.refresh_chunks();
+}
+
+std::size_t visibility_tracker::restamped_count() const noexcept {
+    return restamped;
+}
+
+std::size_t visibility_tracker::memory_usage() const noexcept {
+    return viewer_counts.capacity() * sizeof(uint16_t)
+         + stamps.size() * sizeof(std::pair<const uint32_t, stamp>)
+         + changed_spans.capacity() * sizeof(row_span);
+}
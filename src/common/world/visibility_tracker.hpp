@@ -0,0 +1,71 @@
+#ifndef MMAP_DEMO_VISIBILITY_TRACKER_HPP
+#define MMAP_DEMO_VISIBILITY_TRACKER_HPP
+
+#include "visibility_map.hpp"
+#include "visibility_stencil.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the visibility of a player up to date by stamping only the viewers that changed of tile.
+// Every tile counts the viewers seeing it and becomes explored once the count drops to zero
+class visibility_tracker {
+public:
+    struct viewer {
+        uint32_t id;
+        glm::vec2 position;
+        float radius;
+    };
+private:
+    struct stamp {
+        glm::i32vec2 tile;
+        const visibility_stencil* stencil;
+        uint64_t generation;
+    };
+
+    struct row_span {
+        int y;
+        int first;
+        int last;
+    };
+
+    int width;
+    int height;
+    std::vector<uint16_t> viewer_counts;
+    std::unordered_map<uint32_t, stamp> stamps;
+
+    // The nodes of the map keep the stencils in place
+    std::unordered_map<float, visibility_stencil> stencils;
+
+    // Rows changed by the last update, the other map does not hold them yet
+    std::vector<row_span> changed_spans;
+    uint64_t generation = 0;
+    std::size_t restamped = 0;
+
+    const visibility_stencil& stencil_of(float radius);
+
+    // Counts the tiles [first, last] of a row in or out
+    void see(int y, int first, int last, visibility_map& next);
+    void unsee(int y, int first, int last, visibility_map& next);
+
+    void add(const stamp& s, visibility_map& next);
+    void remove(const stamp& s, visibility_map& next);
+
+    // Only the tiles covered by one of both stamps are counted again
+    void move(const stamp& from, const stamp& to, visibility_map& next);
+public:
+    visibility_tracker(std::size_t width, std::size_t height);
+
+    // Writes the visibility seen by these viewers into next, chunks included. It must be the map updated
+    // before current, both maps are swapped by the owner afterward and current is never modified
+    void update(const std::vector<viewer>& viewers, const visibility_map& current, visibility_map& next);
+
+    // Viewers stamped again by the last update
+    std::size_t restamped_count() const noexcept;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_VISIBILITY_TRACKER_HPP
@@ -0,0 +1,108 @@
+#include "walkability_map.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+
+static_assert(walkability_map::WORD_BITS % world::CHUNK_WIDTH == 0, "a chunk row must fit in a single word");
+
+void walkability_map::resize(int new_width, int new_depth) {
+    const std::size_t new_stride = (new_width + WORD_BITS - 1) / WORD_BITS;
+
+    for(auto& pair : bitmaps) {
+        std::vector<word_type> resized(new_stride * new_depth, 0);
+        for(int z = 0; z < depth; ++z) {
+            std::copy_n(pair.second.begin() + z * stride, stride, resized.begin() + z * new_stride);
+        }
+
+        pair.second = std::move(resized);
+    }
+
+    width = new_width;
+    depth = new_depth;
+    stride = new_stride;
+}
+
+bool walkability_map::is_tracked(movement_class movement) const noexcept {
+    return bitmaps.find(movement) != bitmaps.end();
+}
+
+void walkability_map::track(movement_class movement) {
+    if(!is_tracked(movement)) {
+        bitmaps[movement].assign(stride * depth, 0);
+    }
+}
+
+void walkability_map::update(const world_chunk& chunk) {
+    const world_chunk::position_type pos = chunk.position();
+    if(pos.x < 0 || pos.y < 0) {
+        return;
+    }
+
+    const int start_x = pos.x * static_cast<int>(world::CHUNK_WIDTH);
+    const int start_z = pos.y * static_cast<int>(world::CHUNK_DEPTH);
+    const int end_x = start_x + static_cast<int>(world::CHUNK_WIDTH);
+    const int end_z = start_z + static_cast<int>(world::CHUNK_DEPTH);
+    if(end_x > width || end_z > depth) {
+        resize(std::max(width, end_x), std::max(depth, end_z));
+    }
+
+    const int shift = start_x % WORD_BITS;
+    const word_type chunk_mask = ((word_type{1} << world::CHUNK_WIDTH) - 1) << shift;
+
+    for(auto& pair : bitmaps) {
+        for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+            word_type row_bits = 0;
+            for(int x = 0; x < static_cast<int>(world::CHUNK_WIDTH); ++x) {
+                if(can_walk_on(pair.first, chunk.biome_at(x, 0, z))) {
+                    row_bits |= word_type{1} << x;
+                }
+            }
+
+            word_type& word = pair.second[(start_z + z) * stride + start_x / WORD_BITS];
+            word = (word & ~chunk_mask) | (row_bits << shift);
+        }
+    }
+}
+
+tile_trace walkability_map::trace(movement_class movement, glm::vec2 from, glm::vec2 to) const {
+    auto it = bitmaps.find(movement);
+    const word_type* bits = it != bitmaps.end() ? it->second.data() : nullptr;
+
+    return trace_tiles(from, to, [this, bits](int x, int z) {
+        if(!bits || x < 0 || z < 0 || x >= width || z >= depth) {
+            return false;
+        }
+
+        return ((bits[z * stride + x / WORD_BITS] >> (x % WORD_BITS)) & 1) != 0;
+    });
+}
+
+const walkability_map::word_type* walkability_map::row(movement_class movement, int z) const noexcept {
+    auto it = bitmaps.find(movement);
+    if(it == bitmaps.end() || z < 0 || z >= depth) {
+        return nullptr;
+    }
+
+    return it->second.data() + z * stride;
+}
+
+int walkability_map::tile_width() const noexcept {
+    return width;
+}
+
+int walkability_map::tile_depth() const noexcept {
+    return depth;
+}
+
+std::size_t walkability_map::words_per_row() const noexcept {
+    return stride;
+}
+
+std::size_t walkability_map::memory_usage() const noexcept {
+    std::size_t bytes = 0;
+    for(const auto& pair : bitmaps) {
+        bytes += pair.second.capacity() * sizeof(word_type);
+    }
+
+    return bytes;
+}
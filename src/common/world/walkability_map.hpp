@@ -0,0 +1,61 @@
+#ifndef MMAP_DEMO_WALKABILITY_MAP_HPP
+#define MMAP_DEMO_WALKABILITY_MAP_HPP
+
+#include "world_chunk.hpp"
+#include "movement_class.hpp"
+#include "tile_trace.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One packed bit per tile of the world for each tracked movement class
+class walkability_map {
+public:
+    using word_type = uint64_t;
+
+    static constexpr int WORD_BITS = 64;
+private:
+    int width = 0;
+    int depth = 0;
+    std::size_t stride = 0;
+    std::unordered_map<movement_class, std::vector<word_type>> bitmaps;
+
+    void resize(int new_width, int new_depth);
+
+public:
+    bool is_tracked(movement_class movement) const noexcept;
+
+    // Starts with every tile unwalkable, chunks must be updated afterward
+    void track(movement_class movement);
+
+    // Rewrites the bits of this chunk for every tracked movement class
+    void update(const world_chunk& chunk);
+
+    bool is_walkable(movement_class movement, int x, int z) const noexcept {
+        if(x < 0 || z < 0 || x >= width || z >= depth) {
+            return false;
+        }
+
+        auto it = bitmaps.find(movement);
+        if(it == bitmaps.end()) {
+            return false;
+        }
+
+        return ((it->second[z * stride + x / WORD_BITS] >> (x % WORD_BITS)) & 1) != 0;
+    }
+
+    // First unwalkable tile crossed when moving in a straight line, the bitmap is looked up once
+    tile_trace trace(movement_class movement, glm::vec2 from, glm::vec2 to) const;
+
+    // Bits of a row of tiles, x increasing with the bit index
+    const word_type* row(movement_class movement, int z) const noexcept;
+
+    int tile_width() const noexcept;
+    int tile_depth() const noexcept;
+    std::size_t words_per_row() const noexcept;
+
+    std::size_t memory_usage() const noexcept;
+};
+
+#endif //MMAP_DEMO_WALKABILITY_MAP_HPP
@@ -2,28 +2,66 @@
 #include <algorithm>
 #include <iterator>
 
+const uint32_t world::CHUNK_WIDTH;
+const uint32_t world::CHUNK_HEIGHT;
+const uint32_t world::CHUNK_DEPTH;
+
+void world::make_hot(uint32_t index) {
+    chunks[index].unpack();
+    hot_chunks.push_back(index);
+    while(hot_chunks.size() > hot_capacity) {
+        chunks[hot_chunks.front()].pack();
+        hot_chunks.pop_front();
+    }
+}
+
 world_chunk* world::chunk_at(int x, int z) {
-    auto it = std::find_if(std::begin(chunks), std::end(chunks), [x, z](const world_chunk& chunk) {
-        return chunk.position() == world_chunk::position_type{x, z};
-    });
+    const uint32_t index = chunk_positions.find(x, z);
+    if(index == chunk_index::NONE) {
+        return nullptr;
+    }
 
-    if(it == std::end(chunks)) return nullptr;
+    if(hot_capacity > 0 && chunks[index].is_packed()) {
+        make_hot(index);
+    }
 
-    return &(*it);
+    return &chunks[index];
 }
 
 const world_chunk* world::chunk_at(int x, int z) const {
-    auto it = std::find_if(std::begin(chunks), std::end(chunks), [x, z](const world_chunk& chunk) {
-        return chunk.position() == world_chunk::position_type{x, z};
-    });
-
-    if(it == std::end(chunks)) return nullptr;
-
-    return &(*it);
+    const uint32_t index = chunk_positions.find(x, z);
+    return index != chunk_index::NONE ? &chunks[index] : nullptr;
 }
 
 world_chunk& world::add(int x, int z) {
+    const uint32_t index = chunk_positions.find(x, z);
+    if(index != chunk_index::NONE) {
+        return chunks[index];
+    }
+
     chunks.emplace_back(x, z);
+    chunk_positions.insert(x, z, static_cast<uint32_t>(chunks.size() - 1));
+    extent = glm::max(extent, glm::i32vec2{x + 1, z + 1});
+    if(hot_capacity > 0) {
+        make_hot(static_cast<uint32_t>(chunks.size() - 1));
+    }
+
+    return chunks.back();
+}
+
+world_chunk& world::add(world_chunk&& chunk) {
+    const world_chunk::position_type pos = chunk.position();
+    const uint32_t index = chunk_positions.find(pos.x, pos.y);
+    if(index != chunk_index::NONE) {
+        return chunks[index];
+    }
+
+    chunks.push_back(std::move(chunk));
+    chunk_positions.insert(pos.x, pos.y, static_cast<uint32_t>(chunks.size() - 1));
+    extent = glm::max(extent, glm::i32vec2{pos.x + 1, pos.y + 1});
+    if(hot_capacity > 0) {
+        make_hot(static_cast<uint32_t>(chunks.size() - 1));
+    }
 
     return chunks.back();
 }
@@ -45,7 +83,125 @@ world::const_iterator world::end() const {
 }
 
 bool world::has_chunk(int x, int z) const noexcept {
-    return std::find_if(begin(), end(), [x, z](const world_chunk& chunk) {
-        return chunk.position() == glm::i32vec2{x, z};
-    }) != end();
+    return chunk_positions.find(x, z) != chunk_index::NONE;
+}
+
+void world::pack_cold_chunks(std::size_t hot_capacity) {
+    this->hot_capacity = hot_capacity;
+    hot_chunks.clear();
+    for(uint32_t index = 0; index < chunks.size(); ++index) {
+        if(hot_capacity == 0) {
+            chunks[index].unpack();
+        }
+        else if(!chunks[index].is_packed()) {
+            make_hot(index);
+        }
+    }
+}
+
+glm::i32vec2 world::size() const noexcept {
+    return extent;
+}
+
+void world::track_movement(movement_class movement) {
+    if(walkable_tiles.is_tracked(movement)) {
+        return;
+    }
+
+    walkable_tiles.track(movement);
+    for(const world_chunk& chunk : chunks) {
+        walkable_tiles.update(chunk);
+    }
+}
+
+void world::update_walkability(int x, int z) {
+    const uint32_t index = chunk_positions.find(x, z);
+    if(index != chunk_index::NONE) {
+        walkable_tiles.update(chunks[index]);
+    }
+}
+
+bool world::is_walkable(movement_class movement, int x, int z) const noexcept {
+    if(walkable_tiles.is_tracked(movement)) {
+        return walkable_tiles.is_walkable(movement, x, z);
+    }
+
+    // Untracked movement classes fallback to the biomes
+    if(x < 0 || z < 0) {
+        return false;
+    }
+
+    const world_chunk* chunk = chunk_at(x / static_cast<int>(CHUNK_WIDTH), z / static_cast<int>(CHUNK_DEPTH));
+    return chunk && can_walk_on(movement, chunk->biome_at(x % CHUNK_WIDTH, 0, z % CHUNK_DEPTH));
+}
+
+const walkability_map& world::walkability() const noexcept {
+    return walkable_tiles;
+}
+
+tile_trace world::trace_walkable(movement_class movement, glm::vec2 from, glm::vec2 to) const {
+    if(walkable_tiles.is_tracked(movement)) {
+        return walkable_tiles.trace(movement, from, to);
+    }
+
+    return trace_tiles(from, to, [this, movement](int x, int z) {
+        return is_walkable(movement, x, z);
+    });
+}
+
+void world::update_sites(int x, int z) {
+    const uint32_t index = chunk_positions.find(x, z);
+    if(index != chunk_index::NONE) {
+        site_tiles.update(chunks[index]);
+        occupied_tiles.update(chunks[index]);
+    }
+}
+
+site::quantity world::collect_site(int x, int z, site::id type, site::quantity quantity) {
+    if(x < 0 || z < 0) {
+        return 0;
+    }
+
+    // Collecting changes the sites in place, a packed chunk stays packed
+    const uint32_t index = chunk_positions.find(x / static_cast<int>(CHUNK_WIDTH), z / static_cast<int>(CHUNK_DEPTH));
+    if(index == chunk_index::NONE) {
+        return 0;
+    }
+
+    world_chunk* chunk = &chunks[index];
+
+    site::quantity collected = 0;
+    bool has_remaining = false;
+    for(site& s : chunk->sites_at(x % CHUNK_WIDTH, 0, z % CHUNK_DEPTH)) {
+        if(s.type() != type || s.is_depleted()) {
+            continue;
+        }
+
+        if(collected == 0 && quantity > 0) {
+            const site::quantity before = s.amount();
+            s.collect(quantity);
+            collected = before - s.amount();
+        }
+
+        has_remaining = has_remaining || !s.is_depleted();
+    }
+
+    if(!has_remaining) {
+        site_tiles.remove(type, x, z);
+        occupied_tiles.update_tile(*chunk, x % CHUNK_WIDTH, z % CHUNK_DEPTH);
+    }
+
+    return collected;
+}
+
+const site_index& world::sites() const noexcept {
+    return site_tiles;
+}
+
+occupancy_map& world::occupancy() noexcept {
+    return occupied_tiles;
+}
+
+const occupancy_map& world::occupancy() const noexcept {
+    return occupied_tiles;
 }
\ No newline at end of file
@@ -3,25 +3,54 @@
 
 #include "world_generator.hpp"
 #include "world_chunk.hpp"
+#include "walkability_map.hpp"
+#include "site_index.hpp"
+#include "occupancy_map.hpp"
+#include "movement_class.hpp"
+#include "chunk_index.hpp"
+#include "../async/task.hpp"
+#include "../async/task_executor.hpp"
+#include <algorithm>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 class world {
 public:
-    using chunk_collection = std::vector<world_chunk>;
+    // Chunks never move once added, references to them stay valid
+    using chunk_collection = std::deque<world_chunk>;
     using iterator = chunk_collection::iterator;
     using const_iterator = chunk_collection::const_iterator;
 private:
     chunk_collection chunks;
+    chunk_index chunk_positions;
+    glm::i32vec2 extent{0, 0};
+
+    // Chunks unpacked while the cold ones are packed, the oldest one is packed first
+    std::size_t hot_capacity = 0;
+    std::deque<uint32_t> hot_chunks;
+    walkability_map walkable_tiles;
+    site_index site_tiles;
+    occupancy_map occupied_tiles;
+
+    void make_hot(uint32_t index);
 public:
     static const uint32_t CHUNK_WIDTH = 32;
     static const uint32_t CHUNK_HEIGHT = 1;
     static const uint32_t CHUNK_DEPTH = 32;
 
+    // Only the non-const access unpacks a packed chunk, the const one reads it in place
     virtual world_chunk* chunk_at(int x, int z);
     virtual const world_chunk* chunk_at(int x, int z) const;
 
+    // Returns the chunk at this position, created empty when missing
     world_chunk& add(int x, int z);
+
+    // Moves a chunk built elsewhere into the world, unless its position is already taken
+    world_chunk& add(world_chunk&& chunk);
     iterator begin();
     iterator end();
 
@@ -29,15 +58,131 @@ public:
     const_iterator end() const;
 
     bool has_chunk(int x, int z) const noexcept;
+
+    // Packs every chunk except the hot_capacity ones last added or accessed, 0 unpacks them all
+    void pack_cold_chunks(std::size_t hot_capacity);
+
+    // Number of chunks covered on each axis, starting at the origin
+    glm::i32vec2 size() const noexcept;
+
+    // Keeps a bitmap of the walkable tiles of this movement class
+    void track_movement(movement_class movement);
+
+    // Must be called once the biomes of a chunk are set or changed
+    void update_walkability(int x, int z);
+
+    bool is_walkable(movement_class movement, int x, int z) const noexcept;
+    const walkability_map& walkability() const noexcept;
+
+    // First unwalkable tile crossed by a straight move between two points of the ground plane
+    tile_trace trace_walkable(movement_class movement, glm::vec2 from, glm::vec2 to) const;
+
+    // Must be called once the sites of a chunk are set or changed, also refreshes the occupied tiles
+    void update_sites(int x, int z);
+
+    // Collects from the first site of this type on the tile and returns the quantity taken,
+    // the tile leaves the site index once all its sites of this type are depleted
+    site::quantity collect_site(int x, int z, site::id type, site::quantity quantity);
+
+    const site_index& sites() const noexcept;
+
+    occupancy_map& occupancy() noexcept;
+    const occupancy_map& occupancy() const noexcept;
 };
 
 class infinite_world : public world {
+public:
+    using task_pusher = std::function<async::task_executor::task_future(async::task_executor::task_ptr)>;
+private:
+    // Shared with the generation tasks, they may finish after the world is gone
+    struct generation_queue {
+        uint32_t seed;
+        map_choice choice;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<world_generator>> idle_generators;
+        std::vector<std::unique_ptr<world_chunk>> finished;
+    };
+
+    uint32_t seed;
+    map_choice choice;
     world_generator generator;
+
+    std::shared_ptr<generation_queue> streaming;
+    task_pusher push_generation;
+    std::size_t max_in_flight = 0;
+    std::size_t in_flight = 0;
+
+    // Every chunk requested once, generated or not, and the ones no task was started for yet
+    chunk_index requested_chunks;
+    std::deque<world_chunk::position_type> waiting_chunks;
+
+    // Indexes a chunk once its content is loaded
+    world_chunk& index_loaded(world_chunk& chunk);
+
+    void start_waiting();
 public:
     explicit infinite_world(uint32_t seed, map_choice choice);
 
     world_chunk& generate_at(int x, int z) noexcept;
 
+    // Generates the missing chunks of [0, width) x [0, depth) in batches, push must forward the tasks
+    // to an executor. Every batch owns a generator built from the same seed and the chunks join
+    // the world in the order of a serial generation, x then z
+    template<typename TaskPusher>
+    void generate_area(int width, int depth, std::size_t batch_count, TaskPusher push) {
+        std::vector<world_chunk::position_type> missing;
+        for(int x = 0; x < width; ++x) {
+            for(int z = 0; z < depth; ++z) {
+                if(!has_chunk(x, z)) {
+                    missing.emplace_back(x, z);
+                }
+            }
+        }
+
+        batch_count = std::max<std::size_t>(1, std::min(batch_count, missing.size()));
+
+        // Each batch takes every batch_count chunk, neighbours are spread over the batches
+        std::vector<std::unique_ptr<world_chunk>> generated(missing.size());
+        std::vector<async::task_executor::task_future> batches;
+        for(std::size_t batch = 0; batch < batch_count; ++batch) {
+            batches.push_back(push(async::make_task([this, batch, batch_count, &missing, &generated]() {
+                const world_generator batch_generator(seed, CHUNK_WIDTH, CHUNK_DEPTH, choice);
+                for(std::size_t i = batch; i < missing.size(); i += batch_count) {
+                    generated[i] = std::make_unique<world_chunk>(missing[i].x, missing[i].y);
+
+                    auto generated_chunk = batch_generator.generate_chunk(missing[i].x, 0, missing[i].y);
+                    generated[i]->load(generated_chunk);
+                }
+            })));
+        }
+
+        for(auto& batch : batches) {
+            batch.wait();
+        }
+
+        for(std::unique_ptr<world_chunk>& chunk : generated) {
+            index_loaded(add(std::move(*chunk)));
+        }
+    }
+
+    // Missing chunks are then generated by tasks forwarded to push, at most max_in_flight at once.
+    // chunk_at answers nullptr until they are published instead of generating them in the caller
+    void stream_with(task_pusher push, std::size_t max_in_flight);
+    bool is_streaming() const noexcept;
+
+    // Queues the generation of a missing chunk once, returns whether the chunk is ready
+    bool request(int x, int z);
+
+    // Requests the chunks at most ring chunks away from the center, nearest first
+    void prefetch_around(glm::i32vec2 center, int ring);
+
+    // Adds the chunks generated since the last call and starts the waiting requests,
+    // only the thread owning the world may call it. Returns the positions of the new chunks
+    std::vector<world_chunk::position_type> publish_generated();
+
+    // Requests waiting for a task or being generated
+    std::size_t pending_count() const noexcept;
+
     world_chunk* chunk_at(int x, int z) override;
     const world_chunk* chunk_at(int x, int z) const override;
 
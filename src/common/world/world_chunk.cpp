@@ -3,35 +3,43 @@
 
 #include <algorithm>
 #include <iterator>
-#include <numeric>
+#include <limits>
+
+static_assert(world_chunk::WIDTH == world::CHUNK_WIDTH, "the chunk must be as wide as the world expects");
+static_assert(world_chunk::HEIGHT == world::CHUNK_HEIGHT, "the chunk must be as high as the world expects");
+static_assert(world_chunk::DEPTH == world::CHUNK_DEPTH, "the chunk must be as deep as the world expects");
 
 world_chunk::world_chunk(int x, int z)
-: pos{x, z}{
+: pos{x, z}
+, tiles{std::make_unique<unpacked_tiles>()} {
 
 }
 
 void world_chunk::load(terra_chunk* chunk) noexcept {
-    biomes.reserve(world::CHUNK_WIDTH * world::CHUNK_HEIGHT * world::CHUNK_DEPTH);
+    unpack();
+    clear_sites();
 
-    for(std::size_t y = 0; y < world::CHUNK_HEIGHT; ++y) {
-        for(std::size_t z = 0; z < world::CHUNK_DEPTH; ++z) {
-            for(std::size_t x = 0; x < world::CHUNK_WIDTH; ++x) {
-                biomes.push_back(terra_chunk_biome_at(chunk, x, y, z));
+    std::vector<int> raw_sites;
+    for(int y = 0; y < HEIGHT; ++y) {
+        for(int z = 0; z < DEPTH; ++z) {
+            for(int x = 0; x < WIDTH; ++x) {
+                tiles->biomes[index_of(x, y, z)] = static_cast<uint8_t>(terra_chunk_biome_at(chunk, x, y, z));
 
                 // Fetch the raw sites
-                std::vector<int> raw_sites;
-                std::size_t site_counts = terra_chunk_sites_count_at(chunk, x, y, z);
-                raw_sites.resize(site_counts);
-                terra_chunk_sites_at(chunk, x, y, z, &raw_sites.front(), raw_sites.size());
-
-                std::vector<site> sites;
-                sites.reserve(raw_sites.size());
-                std::transform(std::begin(raw_sites), std::end(raw_sites), std::back_inserter(sites), [](int id) {
+                raw_sites.resize(terra_chunk_sites_count_at(chunk, x, y, z));
+                if(raw_sites.empty()) {
+                    continue;
+                }
+                terra_chunk_sites_at(chunk, x, y, z, raw_sites.data(), raw_sites.size());
+
+                // Tiles are loaded in order, every run is appended to the table
+                tile_sites& range = tiles->site_ranges[index_of(x, y, z)];
+                range.offset = static_cast<uint16_t>(site_table.size());
+                range.count = static_cast<uint16_t>(raw_sites.size());
+                std::transform(std::begin(raw_sites), std::end(raw_sites), std::back_inserter(site_table), [](int id) {
                     // TODO: Initializes the site with a factory
                     return site(static_cast<site::id>(id), 100);
                 });
-
-                this->sites[glm::i32vec3{x, y, z}] = std::move(sites);
             }
         }
     }
@@ -39,95 +47,126 @@ void world_chunk::load(terra_chunk* chunk) noexcept {
 
 void world_chunk::set_biome_at(const std::vector<uint8_t>& biome_vec) noexcept
 {
-    biomes.resize(biome_vec.size());
-    std::copy(biome_vec.begin(), biome_vec.end(), biomes.begin());
+    unpack();
+    std::copy_n(biome_vec.begin(), std::min<std::size_t>(biome_vec.size(), TILE_COUNT), tiles->biomes.begin());
 }
 
 void world_chunk::set_biome_at(std::vector<uint8_t>&& biome_vec) noexcept
 {
-    biomes.resize(biome_vec.size());
-    std::copy(biome_vec.begin(), biome_vec.end(), biomes.begin());
+    unpack();
+    std::copy_n(biome_vec.begin(), std::min<std::size_t>(biome_vec.size(), TILE_COUNT), tiles->biomes.begin());
 }
 
-int world_chunk::biome_at(int x, int y, int z) const noexcept {
-    const std::size_t Y_OFFSET = world::CHUNK_WIDTH * world::CHUNK_DEPTH;
-    const std::size_t Z_OFFSET = world::CHUNK_WIDTH;
-    return biomes[y * Y_OFFSET + z * Z_OFFSET + x];
+void world_chunk::set_biome_at(util::span<const uint8_t> biomes) noexcept
+{
+    unpack();
+    std::copy_n(biomes.begin(), std::min<std::size_t>(biomes.size(), TILE_COUNT), tiles->biomes.begin());
 }
 
-std::vector<site*> world_chunk::sites_at(int x, int y, int z) noexcept {
-    std::vector<site*> ret_sites;
-
-    auto it = sites.find(glm::i32vec3{x, y, z});
-    if(it != sites.end()) {
-        std::transform(std::begin(it->second), std::end(it->second), std::back_inserter(ret_sites), [](site& s) {
-           return &s;
-        });
+void world_chunk::compact_sites() {
+    std::vector<site> compacted;
+    compacted.reserve(site_table.size());
+    for(tile_sites& range : tiles->site_ranges) {
+        const std::size_t offset = compacted.size();
+        std::copy_n(site_table.begin() + range.offset, range.count, std::back_inserter(compacted));
+        range.offset = static_cast<uint16_t>(offset);
     }
 
-    return ret_sites;
+    site_table = std::move(compacted);
 }
 
-std::vector<const site*> world_chunk::sites_at(int x, int y, int z) const noexcept {
-    std::vector<const site*> ret_sites;
+world_chunk::tile_sites world_chunk::packed_range_of(std::size_t tile) const noexcept {
+    const auto run = std::equal_range(site_tiles.begin(), site_tiles.end(), static_cast<uint16_t>(tile));
+    return tile_sites{static_cast<uint16_t>(run.first - site_tiles.begin()), static_cast<uint16_t>(run.second - run.first)};
+}
+
+void world_chunk::set_site_at(int x, int y, int z, site s) noexcept {
+    unpack();
+    tile_sites* range = &tiles->site_ranges[index_of(x, y, z)];
+
+    // A run grows in place only at the end of the table, otherwise it is copied there
+    if(range->offset + range->count != site_table.size()) {
+        if(site_table.size() + range->count + 1 > std::numeric_limits<uint16_t>::max()) {
+            compact_sites();
+        }
 
-    auto it = sites.find(glm::i32vec3{x, y, z});
-    if(it != sites.end()) {
-        std::transform(std::begin(it->second), std::end(it->second), std::back_inserter(ret_sites), [](const site& s) {
-            return &s;
-        });
+        if(range->offset + range->count != site_table.size()) {
+            // Reserved ahead so the copied sites are not moved while being read
+            const std::size_t moved_offset = site_table.size();
+            const std::size_t needed = moved_offset + range->count + 1;
+            if(site_table.capacity() < needed) {
+                site_table.reserve(std::max(needed, site_table.capacity() * 2));
+            }
+            for(std::size_t i = 0; i < range->count; ++i) {
+                site_table.push_back(site_table[range->offset + i]);
+            }
+            range->offset = static_cast<uint16_t>(moved_offset);
+        }
     }
 
-    return ret_sites;
+    site_table.push_back(s);
+    ++range->count;
 }
 
-void world_chunk::set_site_at(int x, int y, int z, site s) noexcept {
-    sites[glm::i32vec3(x, y, z)].push_back(s);
+void world_chunk::clear_sites() noexcept {
+    site_table.clear();
+    site_tiles.clear();
+    if(tiles) {
+        tiles->site_ranges.fill(tile_sites{0, 0});
+    }
 }
 
-world_chunk::position_type world_chunk::position() const noexcept {
-    return pos;
-}
+void world_chunk::pack() {
+    if(!tiles) {
+        return;
+    }
+
+    // Once compacted, the runs follow the order of the tiles
+    compact_sites();
+    site_tiles.resize(site_table.size());
+    for(std::size_t tile = 0; tile < TILE_COUNT; ++tile) {
+        const tile_sites range = tiles->site_ranges[tile];
+        std::fill_n(site_tiles.begin() + range.offset, range.count, static_cast<uint16_t>(tile));
+    }
 
-std::unordered_map<int, double> world_chunk::site_scores() {
-    std::unordered_map<int, double> scores;
-    scores[SITE_TREE] = 10.0;
-    scores[SITE_BERRY] = 8.0;
-    scores[SITE_DEER] = 8.0;
-    scores[SITE_STONE] = 4.0;
-    scores[SITE_MAGIC_ESSENCE] = 4.0;
-    scores[SITE_GOLD] = 4.0;
-    scores[SITE_NOTHING] = 0.0;
-    scores[SITE_FISH] = 0.0;
-
-    return scores;
+    packed_biomes.pack(tiles->biomes.data(), TILE_COUNT);
+    tiles.reset();
+    site_table.shrink_to_fit();
+    site_tiles.shrink_to_fit();
 }
 
-std::unordered_map<int, double> world_chunk::biome_scores() {
-    std::unordered_map<int, double> scores;
-    scores[BIOME_GRASS] = 10.0;
-    scores[BIOME_ROCK] = 5.0;
-    scores[BIOME_DESERT] = 2.0;
-    scores[BIOME_WATER] = 0.0;
-    scores[BIOME_SNOW] = 2.0;
+void world_chunk::unpack() {
+    if(tiles) {
+        return;
+    }
 
-    return scores;
-}
+    tiles = std::make_unique<unpacked_tiles>();
+    packed_biomes.unpack(tiles->biomes.data(), TILE_COUNT);
+    for(std::size_t i = 0; i < site_tiles.size(); ++i) {
+        tile_sites& range = tiles->site_ranges[site_tiles[i]];
+        if(range.count == 0) {
+            range.offset = static_cast<uint16_t>(i);
+        }
+        ++range.count;
+    }
 
-double world_chunk::score() const noexcept {
-    const auto& sites_s = site_scores();
-    const auto& biomes_s = biome_scores();
+    packed_biomes.clear();
+    site_tiles.clear();
+    site_tiles.shrink_to_fit();
+}
 
-    double score = std::accumulate(std::begin(biomes), std::end(biomes), 0.0, [&biomes_s](double current, int biome) {
-        return current + biomes_s.at(biome);
-    });
+bool world_chunk::is_packed() const noexcept {
+    return !tiles;
+}
 
-    score = std::accumulate(std::begin(sites), std::end(sites), score, [&sites_s](double current, auto pair) {
-        if(pair.second.empty()) {
-            return current;
-        }
-        return current + sites_s.at(pair.second.front().type());
-    });
+world_chunk::position_type world_chunk::position() const noexcept {
+    return pos;
+}
 
-    return score;
-}
\ No newline at end of file
+std::size_t world_chunk::memory_usage() const noexcept {
+    return sizeof(*this)
+         + (tiles ? sizeof(unpacked_tiles) : 0)
+         + site_table.capacity() * sizeof(site)
+         + site_tiles.capacity() * sizeof(uint16_t)
+         + packed_biomes.memory_usage();
+}
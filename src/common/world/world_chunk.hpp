@@ -3,23 +3,58 @@
 
 #include "site.hpp"
 #include "constants.hpp"
-#include "../util/vec_hash.hpp"
+#include "packed_tiles.hpp"
+#include "../util/span.hpp"
 
 #include <terratech/terratech.h>
 #include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
-#include <unordered_map>
 
 class world_chunk {
 public:
     using position_type = glm::i32vec2;
+
+    // Checked against the world in the implementation
+    static constexpr int WIDTH = 32;
+    static constexpr int HEIGHT = 1;
+    static constexpr int DEPTH = 32;
+    static constexpr int TILE_COUNT = WIDTH * HEIGHT * DEPTH;
 private:
-    std::vector<int> biomes;
+    // The sites of a tile are contiguous in the site table
+    struct tile_sites {
+        uint16_t offset;
+        uint16_t count;
+    };
+
+    // Released while the chunk is packed
+    struct unpacked_tiles {
+        std::array<uint8_t, TILE_COUNT> biomes;
+        std::array<tile_sites, TILE_COUNT> site_ranges;
+    };
+
     const position_type pos;
-    std::unordered_map<glm::i32vec3, std::vector<site>, util::vec3_hash<glm::i32vec3>> sites;
+    std::unique_ptr<unpacked_tiles> tiles;
+    std::vector<site> site_table;
+
+    // While packed, the tile of each site of the table, the table is then sorted by tile
+    packed_tiles packed_biomes;
+    std::vector<uint16_t> site_tiles;
+
+    static std::size_t index_of(int x, int y, int z) noexcept {
+        return (static_cast<std::size_t>(y) * DEPTH + z) * WIDTH + x;
+    }
+
+    // Drops the sites left behind when a tile had to move its run to the end of the table
+    void compact_sites();
 
-    static std::unordered_map<int, double> site_scores();
-    static std::unordered_map<int, double> biome_scores();
+    tile_sites packed_range_of(std::size_t tile) const noexcept;
+
+    tile_sites range_of(std::size_t tile) const noexcept {
+        return tiles ? tiles->site_ranges[tile] : packed_range_of(tile);
+    }
 public:
     world_chunk(int x, int z);
     /**
@@ -29,15 +64,51 @@ public:
     void load(terra_chunk* chunk) noexcept;
     void set_biome_at(const std::vector<uint8_t>& biome_vec) noexcept;
     void set_biome_at(std::vector<uint8_t>&& biome_vec) noexcept;
-    int biome_at(int x, int y, int z) const noexcept;
-    std::vector<site*> sites_at(int x, int y, int z) noexcept;
-    std::vector<const site*> sites_at(int x, int y, int z) const noexcept;
+    void set_biome_at(util::span<const uint8_t> biomes) noexcept;
+
+    int biome_at(int x, int y, int z) const noexcept {
+        const std::size_t tile = index_of(x, y, z);
+        return tiles ? tiles->biomes[tile] : packed_biomes.at(tile);
+    }
+
+    // The spans stay valid until a site is added, the sites are cleared or the chunk is packed
+    util::span<site> sites_at(int x, int y, int z) noexcept {
+        const tile_sites range = range_of(index_of(x, y, z));
+        return util::span<site>(site_table.data() + range.offset, range.count);
+    }
+
+    util::span<const site> sites_at(int x, int y, int z) const noexcept {
+        const tile_sites range = range_of(index_of(x, y, z));
+        return util::span<const site>(site_table.data() + range.offset, range.count);
+    }
 
     void set_site_at(int x, int y, int z, site s) noexcept;
+    void clear_sites() noexcept;
+
+    // Calls fn(position, site) for every site of the chunk, tile by tile
+    template<typename Fn>
+    void for_each_site(Fn fn) const {
+        for(int y = 0; y < HEIGHT; ++y) {
+            for(int z = 0; z < DEPTH; ++z) {
+                for(int x = 0; x < WIDTH; ++x) {
+                    for(const site& s : sites_at(x, y, z)) {
+                        fn(glm::i32vec3{x, y, z}, s);
+                    }
+                }
+            }
+        }
+    }
+
+    // A packed chunk keeps its biomes in a palette and only the tile of each site, it is still
+    // read in place. Changing its biomes or adding a site unpacks it first
+    void pack();
+    void unpack();
+    bool is_packed() const noexcept;
 
     position_type position() const noexcept;
 
-    double score() const noexcept;
+    // Bytes held by the chunk, itself included
+    std::size_t memory_usage() const noexcept;
 };
 
 #endif //MMAP_DEMO_WORLD_CHUNK_H
@@ -0,0 +1,306 @@
+#include "world_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <system_error>
+
+namespace {
+
+const char MAGIC[8] = {'M', 'M', 'A', 'P', 'W', 'R', 'L', 'D'};
+
+// Read back differently by a host of the other endianness
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+const std::size_t TILE_COUNT = world::CHUNK_WIDTH * world::CHUNK_DEPTH;
+
+uint64_t aligned(uint64_t offset) noexcept {
+    return (offset + 7) & ~uint64_t{7};
+}
+
+// Sums of a score table over the tiles of width x depth chunks, with its row and column of zeros
+uint64_t sum_count(uint64_t width, uint64_t depth) noexcept {
+    return (width * world::CHUNK_WIDTH + 1) * (depth * world::CHUNK_DEPTH + 1);
+}
+
+const char* name_of(map_choice map) noexcept {
+    switch(map) {
+        case map_choice::RIVER_MAP:
+            return "river";
+        case map_choice::ISLAND_MAP:
+            return "island";
+        case map_choice::LAKE_MAP:
+            return "lake";
+        case map_choice::PLAIN_MAP:
+        default:
+            return "plain";
+    }
+}
+
+// The section of count values of this size starting at offset ends before limit, without overflowing
+bool fits(uint64_t offset, uint64_t count, uint64_t value_size, uint64_t limit) noexcept {
+    return offset <= limit && count <= (limit - offset) / value_size;
+}
+
+template<typename Values>
+void write_section(std::ofstream& stream, uint64_t offset, const Values& values) {
+    stream.seekp(static_cast<std::streamoff>(offset));
+    stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(*values.data())));
+}
+
+}
+
+static_assert(world::CHUNK_HEIGHT == 1, "the file stores a single layer of tiles");
+static_assert(TILE_COUNT <= 65536, "a tile index must fit in a stored site");
+
+std::string world_file::path_for(uint32_t seed, map_choice map, int width, int depth) {
+    return "world_cache/" + std::string(name_of(map)) + "-" + std::to_string(seed) + "-"
+         + std::to_string(width) + "x" + std::to_string(depth) + ".world";
+}
+
+bool world_file::write(const std::string& path, const world& w, uint32_t seed, map_choice map, int width, int depth,
+                       const score_table& scores, const std::vector<glm::i32vec2>& spawn_chunks) {
+    const std::size_t chunk_count = static_cast<std::size_t>(width) * depth;
+
+    // The table is indexed by tile, it must cover exactly the chunks written
+    const util::span<const score_table::sum_type> biome_sums = scores.biome_table();
+    const util::span<const score_table::sum_type> site_sums = scores.site_table();
+    if(scores.size() != glm::i32vec2(width * static_cast<int>(world::CHUNK_WIDTH), depth * static_cast<int>(world::CHUNK_DEPTH))
+    || biome_sums.size() != sum_count(width, depth)
+    || site_sums.size() != sum_count(width, depth)) {
+        return false;
+    }
+
+    std::vector<uint8_t> biomes;
+    std::vector<uint32_t> site_offsets;
+    std::vector<stored_site> sites;
+    biomes.reserve(chunk_count * TILE_COUNT);
+    site_offsets.reserve(chunk_count + 1);
+    for(int x = 0; x < width; ++x) {
+        for(int z = 0; z < depth; ++z) {
+            const world_chunk* chunk = w.chunk_at(x, z);
+            if(!chunk) {
+                return false;
+            }
+
+            site_offsets.push_back(static_cast<uint32_t>(sites.size()));
+            for(int tile_z = 0; tile_z < static_cast<int>(world::CHUNK_DEPTH); ++tile_z) {
+                for(int tile_x = 0; tile_x < static_cast<int>(world::CHUNK_WIDTH); ++tile_x) {
+                    biomes.push_back(static_cast<uint8_t>(chunk->biome_at(tile_x, 0, tile_z)));
+
+                    const uint16_t tile = static_cast<uint16_t>(tile_z * world::CHUNK_WIDTH + tile_x);
+                    for(const site& s : chunk->sites_at(tile_x, 0, tile_z)) {
+                        sites.push_back(stored_site{tile, static_cast<uint16_t>(s.type()), s.amount()});
+                    }
+                }
+            }
+        }
+    }
+    site_offsets.push_back(static_cast<uint32_t>(sites.size()));
+
+    std::vector<stored_position> spawns;
+    for(const glm::i32vec2& spawn : spawn_chunks) {
+        spawns.push_back(stored_position{spawn.x, spawn.y});
+    }
+
+    header head{};
+    std::copy(std::begin(MAGIC), std::end(MAGIC), head.magic);
+    head.version = VERSION;
+    head.byte_order = BYTE_ORDER_MARK;
+    head.seed = seed;
+    head.map = static_cast<uint32_t>(map);
+    head.width = static_cast<uint32_t>(width);
+    head.depth = static_cast<uint32_t>(depth);
+    head.chunk_width = world::CHUNK_WIDTH;
+    head.chunk_depth = world::CHUNK_DEPTH;
+    head.site_count = static_cast<uint32_t>(sites.size());
+    head.spawn_count = static_cast<uint32_t>(spawns.size());
+    head.biomes_offset = aligned(sizeof(header));
+    head.site_offsets_offset = aligned(head.biomes_offset + biomes.size());
+    head.sites_offset = aligned(head.site_offsets_offset + site_offsets.size() * sizeof(uint32_t));
+    head.biome_sums_offset = aligned(head.sites_offset + sites.size() * sizeof(stored_site));
+    head.site_sums_offset = aligned(head.biome_sums_offset + biome_sums.size() * sizeof(score_table::sum_type));
+    head.spawns_offset = aligned(head.site_sums_offset + site_sums.size() * sizeof(score_table::sum_type));
+    head.file_size = head.spawns_offset + spawns.size() * sizeof(stored_position);
+
+    // The default location is under world_cache, missing on a fresh checkout
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::error_code error;
+    if(!directory.empty()) {
+        std::filesystem::create_directories(directory, error);
+        if(error) {
+            return false;
+        }
+    }
+
+    // Written under another name first, a server starting meanwhile never maps half a file
+    const std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+        if(!stream.is_open()) {
+            return false;
+        }
+
+        // The padding between the sections is zeroed
+        const std::vector<char> zeros(static_cast<std::size_t>(head.file_size), 0);
+        stream.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char*>(&head), sizeof(head));
+        write_section(stream, head.biomes_offset, biomes);
+        write_section(stream, head.site_offsets_offset, site_offsets);
+        write_section(stream, head.sites_offset, sites);
+        write_section(stream, head.biome_sums_offset, biome_sums);
+        write_section(stream, head.site_sums_offset, site_sums);
+        write_section(stream, head.spawns_offset, spawns);
+
+        if(!stream.good()) {
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+bool world_file::open(const std::string& path) {
+    head = nullptr;
+    if(!mapping.open(path) || mapping.size() < sizeof(header)) {
+        return false;
+    }
+
+    const header* candidate = section<header>(0);
+    if(std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0
+    || candidate->version != VERSION
+    || candidate->byte_order != BYTE_ORDER_MARK
+    || candidate->chunk_width != world::CHUNK_WIDTH
+    || candidate->chunk_depth != world::CHUNK_DEPTH
+    || candidate->file_size != mapping.size()) {
+        mapping.close();
+        return false;
+    }
+
+    // Every section must lie in the file, in order and aligned for its values. The biomes are
+    // checked first, bounding the size of the score tables computed after them
+    const uint64_t chunk_count = static_cast<uint64_t>(candidate->width) * candidate->depth;
+    const bool is_complete = candidate->width <= static_cast<uint32_t>(std::numeric_limits<int32_t>::max())
+                          && candidate->depth <= static_cast<uint32_t>(std::numeric_limits<int32_t>::max())
+                          && candidate->biomes_offset >= sizeof(header)
+                          && fits(candidate->biomes_offset, chunk_count, TILE_COUNT, candidate->site_offsets_offset)
+                          && fits(candidate->site_offsets_offset, chunk_count + 1, sizeof(uint32_t), candidate->sites_offset)
+                          && fits(candidate->sites_offset, candidate->site_count, sizeof(stored_site), candidate->biome_sums_offset)
+                          && fits(candidate->biome_sums_offset, sum_count(candidate->width, candidate->depth), sizeof(score_table::sum_type), candidate->site_sums_offset)
+                          && fits(candidate->site_sums_offset, sum_count(candidate->width, candidate->depth), sizeof(score_table::sum_type), candidate->spawns_offset)
+                          && fits(candidate->spawns_offset, candidate->spawn_count, sizeof(stored_position), candidate->file_size)
+                          && candidate->site_offsets_offset % alignof(uint32_t) == 0
+                          && candidate->sites_offset % alignof(stored_site) == 0
+                          && candidate->biome_sums_offset % alignof(score_table::sum_type) == 0
+                          && candidate->site_sums_offset % alignof(score_table::sum_type) == 0
+                          && candidate->spawns_offset % alignof(stored_position) == 0;
+    if(!is_complete) {
+        mapping.close();
+        return false;
+    }
+
+    head = candidate;
+    if(!has_valid_content()) {
+        head = nullptr;
+        mapping.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool world_file::has_valid_content() const noexcept {
+    const uint64_t chunk_count = static_cast<uint64_t>(head->width) * head->depth;
+
+    const uint8_t* biomes = section<uint8_t>(head->biomes_offset);
+    const bool are_biomes_valid = std::all_of(biomes, biomes + chunk_count * TILE_COUNT, [](uint8_t biome) {
+        return biome < BIOME_COUNT;
+    });
+
+    // The sites of a chunk follow those of the previous one and every site is in the table
+    const uint32_t* site_offsets = section<uint32_t>(head->site_offsets_offset);
+    const bool are_offsets_valid = site_offsets[0] == 0
+                                && site_offsets[chunk_count] == head->site_count
+                                && std::is_sorted(site_offsets, site_offsets + chunk_count + 1);
+
+    // A tile past the chunk would be written past its tiles by set_site_at
+    const stored_site* sites = section<stored_site>(head->sites_offset);
+    const bool are_sites_valid = std::all_of(sites, sites + head->site_count, [](const stored_site& s) {
+        return s.tile < TILE_COUNT && s.type < SITE_COUNT;
+    });
+
+    const stored_position* spawns = section<stored_position>(head->spawns_offset);
+    const bool are_spawns_valid = std::all_of(spawns, spawns + head->spawn_count, [this](const stored_position& spawn) {
+        return spawn.x >= 0 && spawn.z >= 0
+            && static_cast<uint32_t>(spawn.x) < head->width
+            && static_cast<uint32_t>(spawn.z) < head->depth;
+    });
+
+    return are_biomes_valid && are_offsets_valid && are_sites_valid && are_spawns_valid;
+}
+
+bool world_file::matches(uint32_t seed, map_choice map, int width, int depth) const noexcept {
+    return head
+        && head->seed == seed
+        && head->map == static_cast<uint32_t>(map)
+        && head->width == static_cast<uint32_t>(width)
+        && head->depth == static_cast<uint32_t>(depth);
+}
+
+void world_file::load_into(world& w) const {
+    if(!head) {
+        return;
+    }
+
+    const uint8_t* biomes = section<uint8_t>(head->biomes_offset);
+    const uint32_t* site_offsets = section<uint32_t>(head->site_offsets_offset);
+    const stored_site* sites = section<stored_site>(head->sites_offset);
+
+    std::size_t chunk_number = 0;
+    for(int x = 0; x < static_cast<int>(head->width); ++x) {
+        for(int z = 0; z < static_cast<int>(head->depth); ++z, ++chunk_number) {
+            world_chunk chunk(x, z);
+
+            chunk.set_biome_at(util::span<const uint8_t>(biomes + chunk_number * TILE_COUNT, TILE_COUNT));
+
+            for(uint32_t i = site_offsets[chunk_number]; i < site_offsets[chunk_number + 1]; ++i) {
+                chunk.set_site_at(sites[i].tile % world::CHUNK_WIDTH, 0, sites[i].tile / world::CHUNK_WIDTH,
+                                  site(static_cast<site::id>(sites[i].type), sites[i].amount));
+            }
+
+            w.add(std::move(chunk));
+            w.update_walkability(x, z);
+            w.update_sites(x, z);
+        }
+    }
+}
+
+void world_file::load_scores_into(score_table& scores) const {
+    if(!head) {
+        return;
+    }
+
+    const std::size_t count = static_cast<std::size_t>(sum_count(head->width, head->depth));
+    scores.assign(static_cast<int>(head->width * world::CHUNK_WIDTH), static_cast<int>(head->depth * world::CHUNK_DEPTH),
+                  util::span<const score_table::sum_type>(section<score_table::sum_type>(head->biome_sums_offset), count),
+                  util::span<const score_table::sum_type>(section<score_table::sum_type>(head->site_sums_offset), count));
+}
+
+std::vector<glm::i32vec2> world_file::spawn_chunks() const {
+    std::vector<glm::i32vec2> spawns;
+    if(!head) {
+        return spawns;
+    }
+
+    const stored_position* stored = section<stored_position>(head->spawns_offset);
+    for(uint32_t i = 0; i < head->spawn_count; ++i) {
+        spawns.emplace_back(stored[i].x, stored[i].z);
+    }
+
+    return spawns;
+}
@@ -0,0 +1,87 @@
+#ifndef MMAP_DEMO_WORLD_FILE_HPP
+#define MMAP_DEMO_WORLD_FILE_HPP
+
+#include "score_table.hpp"
+#include "world.hpp"
+#include "world_generator.hpp"
+#include "../memory/mapped_file.hpp"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Generated world saved once and mapped on the next starts. Every section is an array
+// following the header, the chunks are stored x then z like a serial generation and the
+// score tables row by row over the tiles of the whole area
+class world_file {
+public:
+    static const uint32_t VERSION = 2;
+
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t seed;
+        uint32_t map;
+        uint32_t width;
+        uint32_t depth;
+        uint32_t chunk_width;
+        uint32_t chunk_depth;
+        uint32_t site_count;
+        uint32_t spawn_count;
+
+        // Byte offsets of the sections from the start of the file
+        uint64_t biomes_offset;
+        uint64_t site_offsets_offset;
+        uint64_t sites_offset;
+        uint64_t biome_sums_offset;
+        uint64_t site_sums_offset;
+        uint64_t spawns_offset;
+        uint64_t file_size;
+    };
+
+    struct stored_site {
+        uint16_t tile;
+        uint16_t type;
+        uint32_t amount;
+    };
+
+    struct stored_position {
+        int32_t x;
+        int32_t z;
+    };
+private:
+    memory::mapped_file mapping;
+    const header* head = nullptr;
+
+    template<typename T>
+    const T* section(uint64_t offset) const noexcept {
+        return reinterpret_cast<const T*>(mapping.data() + offset);
+    }
+
+    // Biomes, site tiles and types, site offsets and spawns are all in range
+    bool has_valid_content() const noexcept;
+public:
+    // Default location of the world baked for these settings
+    static std::string path_for(uint32_t seed, map_choice map, int width, int depth);
+
+    // Writes the chunks of [0, width) x [0, depth), the score table built over them and the spawns
+    static bool write(const std::string& path, const world& w, uint32_t seed, map_choice map, int width, int depth,
+                      const score_table& scores, const std::vector<glm::i32vec2>& spawn_chunks);
+
+    // Maps the file, false when it is missing, truncated, corrupted or written by another version
+    bool open(const std::string& path);
+
+    bool matches(uint32_t seed, map_choice map, int width, int depth) const noexcept;
+
+    // Adds every chunk to the world with its walkable tiles and sites indexed. The chunks own
+    // their tiles, packed and unpacked in place, so they are copied out of the mapping
+    void load_into(world& w) const;
+
+    // Replaces the table by the one saved, as built over the chunks added by load_into
+    void load_scores_into(score_table& scores) const;
+    std::vector<glm::i32vec2> spawn_chunks() const;
+};
+
+#endif //MMAP_DEMO_WORLD_FILE_HPP
@@ -6,16 +6,22 @@
 #include "../common/networking/world_chunk.hpp"
 #include "../common/networking/networking_constant.hpp"
 
+#include <array>
 #include <thread>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <future>
+#include <unordered_set>
+#include <cmath>
 #include "server_unit_manager.hpp"
 #include "../common/networking/update_target.hpp"
 #include "../common/task/update_player_visibility.hpp"
 #include "../common/task/update_units.hpp"
 #include "../common/networking/player_init.hpp"
+#include "../common/world/spawn_search.hpp"
+#include "../common/world/world_file.hpp"
 
 // The states:
 //  - lobby
@@ -24,17 +30,28 @@
 // TODO:
 // Keep track of what each player can see
 
+constexpr std::chrono::milliseconds authoritative_game::TICK_BUDGET;
+constexpr float authoritative_game::NEAR_PLAYER_DISTANCE;
+
 authoritative_game::authoritative_game()
-: base_game(std::thread::hardware_concurrency() - 1, std::make_unique<server_unit_manager>())
-, world(static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count()), map_choice::PLAIN_MAP)
-, network(3) {
+: authoritative_game(map_choice::PLAIN_MAP) {
 
 }
 
 authoritative_game::authoritative_game(map_choice chosen_map)
+: authoritative_game(chosen_map, static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count())) {
+
+}
+
+authoritative_game::authoritative_game(map_choice chosen_map, uint32_t seed)
     : base_game(std::thread::hardware_concurrency() - 1, std::make_unique<server_unit_manager>())
-    , world(static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count()), chosen_map)
-    , network(3) {
+    , seed(seed)
+    , chosen_map(chosen_map)
+    , world(seed, chosen_map)
+    , pathfinder(world)
+    , unit_paths(pathfinder)
+    , network(3)
+    , governor(TICK_BUDGET) {
 }
 
 
@@ -65,214 +82,62 @@ void authoritative_game::load_assets() {
     // TODO: Load world generation
 }
 
-class chunk_score_task : public async::base_task {
-    const world_chunk& chunk_;
-    double score_;
-protected:
-    void set_score(double value) {
-        score_ = value;
-    }
-public:
-    chunk_score_task(const world_chunk& chunk)
-    : chunk_(chunk)
-    , score_(0.0) {
-
-    }
-
-    double score() const noexcept {
-        return score_;
-    }
-
-    const world_chunk& chunk() const {
-        return chunk_;
-    }
-};
-
-class chunk_score_calculator_task : public chunk_score_task {
-public:
-    explicit chunk_score_calculator_task(const world_chunk& chunk)
-    : chunk_score_task(chunk) {
-
-    }
-
-    void execute() override {
-        set_score(chunk().score());
-    }
-};
-
-class starting_point_finding_task : public async::base_task {
-public:
-    using iterator = std::unordered_map<std::size_t, std::vector<std::size_t>>::const_iterator;
-private:
-    std::pair<std::size_t, std::size_t> found_pair;
-    const std::vector<std::tuple<int, int, double>>& region_scores;
-    iterator begin;
-    iterator end;
-public:
-    starting_point_finding_task(iterator begin, iterator end, const std::vector<std::tuple<int, int, double>>& regions)
-    : region_scores(regions)
-    , begin(begin)
-    , end(end) {
-
+void authoritative_game::generate_world() {
+    // A world baked offline for the same settings skips the generation and the spawn search
+    world_file baked;
+    const std::string baked_path = world_file::path_for(seed, chosen_map, WORLD_SIZE, WORLD_SIZE);
+    game_time::highres_clock generation_clock;
+    const bool is_baked = baked.open(baked_path) && baked.matches(seed, chosen_map, WORLD_SIZE, WORLD_SIZE) && baked.spawn_chunks().size() >= MAX_CLIENT_COUNT;
+    if(is_baked) {
+        std::cout << "loading baked world '" << baked_path << "'..." << std::endl;
+        baked.load_into(world);
+
+        baked.load_scores_into(world_scores);
+        spawn_chunks = baked.spawn_chunks();
+        std::cout << "loaded in " << generation_clock.elapsed_time<std::chrono::milliseconds>().count() << " ms" << std::endl;
     }
-
-    void execute() override {
-        double bigest_score = -1.0;
-        std::for_each(begin, end, [this, &bigest_score](const auto& pair) {
-            const double score_to_match = std::get<2>(region_scores[pair.first]);
-
-            if(score_to_match > bigest_score) {
-                auto best_match = std::min_element(std::begin(pair.second), std::end(pair.second),
-                                                   [this, score_to_match](std::size_t a, std::size_t b) {
-                                                       const double score_diff_a = std::abs(
-                                                               score_to_match - std::get<2>(region_scores[a]));
-                                                       const double score_diff_b = std::abs(
-                                                               score_to_match - std::get<2>(region_scores[b]));
-
-                                                       return score_diff_a < score_diff_b;
-                                                   });
-                auto best_match_pair = std::make_pair(pair.first, *best_match);
-                std::swap(found_pair, best_match_pair);
-                bigest_score = score_to_match;
-            }
+    else {
+        std::cout << "generating world of seed " << seed << "..." << std::endl;
+        world.generate_area(WORLD_SIZE, WORLD_SIZE, std::max(1u, std::thread::hardware_concurrency()), [this](async::task_executor::task_ptr task) {
+            return push_task(std::move(task));
         });
+        std::cout << "generated in " << generation_clock.elapsed_time<std::chrono::milliseconds>().count() << " ms" << std::endl;
     }
 
-    std::pair<std::size_t, std::size_t> found() const noexcept {
-        return found_pair;
-    }
-};
-
-void authoritative_game::find_spawn_chunks() {
-    std::vector<async::task_executor::task_future> chunk_scores_tasks;
-    std::transform(std::begin(world), std::end(world), std::back_inserter(chunk_scores_tasks), [this](const world_chunk& chunk) {
-        return push_task(std::make_unique<chunk_score_calculator_task>(chunk));
-    });
+    auto push = [this](async::task_executor::task_ptr task) {
+        return push_task(std::move(task));
+    };
 
-    // TODO: Do other stuff here
-
-    std::unordered_map<glm::i32vec2, double, util::vec2_hash<glm::i32vec2>> chunk_scores;
-    for(async::task_executor::task_future& future : chunk_scores_tasks) {
-        async::task_executor::task_ptr task = future.get();
-        chunk_score_calculator_task* calculated_score = static_cast<chunk_score_calculator_task*>(task.get());
-        chunk_scores.emplace(glm::i32vec2(calculated_score->chunk().position().x, calculated_score->chunk().position().y), calculated_score->score());
+    // Scores of the initial area, the chunks streamed later are never candidates for a spawn
+    if(!is_baked) {
+        world_scores.build(world, std::max(1u, std::thread::hardware_concurrency()), push);
+        spawn_chunks = choose_spawn_chunks(world, world_scores, MAX_CLIENT_COUNT, std::max(1u, std::thread::hardware_concurrency()), push);
     }
 
-    std::vector<std::tuple<int, int, double>> region_scores;
-    std::for_each(std::begin(chunk_scores), std::end(chunk_scores), [&chunk_scores, &region_scores](const std::pair<glm::i32vec2, double>& pair) {
-        std::vector<double> n;
-
-        if(pair.first.x > 0) {
-            n.push_back(chunk_scores[{pair.first.x - 1, pair.first.y}]);
-
-            if(pair.first.y > 0) {
-                n.push_back(chunk_scores[{pair.first.x - 1, pair.first.y - 1}]);
-            }
-
-            if(pair.first.y < 20) {
-                n.push_back(chunk_scores[{pair.first.x - 1, pair.first.y + 1}]);
-            }
-        }
-
-        if(pair.first.y > 0) {
-            n.push_back(chunk_scores[{pair.first.x, pair.first.y - 1}]);
-        }
-
-        if(pair.first.x < 20) {
-            n.push_back(chunk_scores[{pair.first.x + 1, pair.first.y}]);
-
-            if(pair.first.y > 0) {
-                n.push_back(chunk_scores[{pair.first.x + 1, pair.first.y - 1}]);
-            }
-
-            if(pair.first.y < 20) {
-                n.push_back(chunk_scores[{pair.first.x + 1, pair.first.y + 1}]);
-            }
-        }
+    // Past the initial area, chunks are generated in the background while the game runs
+    world.stream_with([this](async::task_executor::task_ptr task) {
+        return push_task(std::move(task));
+    }, std::max(1u, std::thread::hardware_concurrency() / 2));
 
-        if(pair.first.y < 20) {
-            n.push_back(chunk_scores[{pair.first.x, pair.first.y + 1}]);
-        }
-
-        region_scores.emplace_back(pair.first.x, pair.first.y, std::accumulate(std::begin(n), std::end(n), pair.second));
-    });
-
-    std::sort(std::begin(region_scores), std::end(region_scores), [](const std::tuple<int, int, double>& a, const std::tuple<int, int, double>& b) {
-        return std::get<2>(a) < std::get<2>(b);
-    });
-
-    std::size_t chunk_a_index = 0;
-    std::size_t chunk_b_index = 1;
-
-    // Associate each chunk with other chunk to check
-    std::unordered_map<std::size_t, std::vector<std::size_t>> indices_to_check;
-
-    for(std::size_t i = 0; i < region_scores.size(); ++i) {
-        for(std::size_t j = 0; j < region_scores.size(); ++j) {
-            if(i != j) {
-                // Check if an association may be done
-                const glm::vec2 chunk_a_pos(std::get<0>(region_scores[i]), std::get<1>(region_scores[i]));
-                const glm::vec2 chunk_b_pos(std::get<0>(region_scores[j]), std::get<1>(region_scores[j]));
-
-                float dist = glm::length(chunk_b_pos - chunk_a_pos);
-                // Players must be separated by at least 5 chunks
-                if(dist > 10.f) {
-                    indices_to_check[i].push_back(j);
-                }
-            }
-        }
+    // Precomputes the walkable tiles and the portals of every kind of movement
+    std::cout << "building pathfinding graphs..." << std::endl;
+    std::unordered_set<movement_class> distinct_movements;
+    for(const unit_flyweight& flyweight : unit_flyweights()) {
+        distinct_movements.insert(flyweight.movement());
     }
+    movements.assign(std::begin(distinct_movements), std::end(distinct_movements));
 
-    // Splits the load on 4 threads
-    const std::size_t BUCKET_COUNT = 4;
-    const std::size_t BUCKET_SIZE = (indices_to_check.size() / BUCKET_COUNT) + 1;
-    std::size_t missing_count = indices_to_check.size();
-
-    // Create 4 processing batch
-    std::vector<async::task_executor::task_future> bucket_futures;
-    auto begin_of_bucket = std::begin(indices_to_check);
-    for(std::size_t i = 0; i < BUCKET_COUNT; ++i) {
-        const std::size_t size = std::min(BUCKET_SIZE, missing_count);
-
-        auto end_of_bucket = std::next(begin_of_bucket, size);
-        bucket_futures.push_back(push_task(std::make_unique<starting_point_finding_task>(std::begin(indices_to_check),
-                                                                                         std::end(indices_to_check),
-                                                                                         region_scores)));
-
-        begin_of_bucket = end_of_bucket;
-        missing_count -= size;
+    for(movement_class movement : movements) {
+        world.track_movement(movement);
+        pathfinder.build(movement);
     }
 
-    // Wait every batch to be processed
-    std::vector<std::pair<std::size_t, std::size_t>> best_pairs;
-    std::transform(std::begin(bucket_futures), std::end(bucket_futures), std::back_inserter(best_pairs), [](async::task_executor::task_future& future) {
-        auto task = future.get();
-        starting_point_finding_task* finding_task = static_cast<starting_point_finding_task*>(task.get());
-
-        return finding_task->found();
-    });
-
-    // Find best score in matching points
-    auto best_pair = std::max_element(std::begin(best_pairs), std::end(best_pairs),
-                                      [&region_scores](const std::pair<std::size_t, std::size_t>& a,
-                                                       const std::pair<std::size_t, std::size_t>& b) {
-                                          return std::get<2>(region_scores[a.first]) < std::get<2>(region_scores[b.first]);
-                                      });
-
-    spawn_chunks[0] = glm::i32vec2(std::get<0>(region_scores[best_pair->first]), std::get<1>(region_scores[best_pair->first]));
-    spawn_chunks[1] = glm::i32vec2(std::get<0>(region_scores[best_pair->second]), std::get<1>(region_scores[best_pair->second]));
-}
-
-void authoritative_game::generate_world() {
-    std::cout << "generating world..." << std::endl;
-
-    for(std::size_t x = 0; x < 20; ++x) {
-        for(std::size_t z = 0; z < 20; ++z) {
-            world_chunk& chunk = world.generate_at(x, z);
-        }
+    std::cout << "labeling walkable regions..." << std::endl;
+    for(movement_class movement : movements) {
+        regions.build(world.walkability(), world.size(), movement, [this](async::task_executor::task_ptr task) {
+            return push_task(std::move(task));
+        });
     }
-
-    find_spawn_chunks();
 }
 
 void authoritative_game::setup_listener() {
@@ -321,44 +186,122 @@ void authoritative_game::on_init() {
 
 void authoritative_game::send_flyweights(networking::network_manager::socket_handle client) {
     std::cout << "sending flyweights..." << std::endl;
-    std::unordered_map<std::string, unit_flyweight> serialized_flyweights;
-    for(auto it = unit_flyweights().begin(); it != unit_flyweights().end(); ++it) {
-        serialized_flyweights.emplace(std::to_string(it->first), it->second);
+    // Sent in the order of the table so the units can be sent with their dense index
+    const std::vector<unit_flyweight> ordered_flyweights(std::begin(unit_flyweights()), std::end(unit_flyweights()));
+    network.send_to(networking::packet::make(ordered_flyweights, PACKET_SETUP_FLYWEIGHTS), client);
+}
+
+namespace {
+
+networking::world_chunk to_network_chunk(const world_chunk& chunk) {
+    std::vector<uint8_t> biomes;
+    biomes.reserve(world::CHUNK_WIDTH * world::CHUNK_HEIGHT * world::CHUNK_DEPTH);
+
+    std::vector<networking::resource> resources;
+    // SETUP BIOMES
+    for(uint32_t y = 0; y < world::CHUNK_HEIGHT; ++y) {
+        for(uint32_t z = 0; z < world::CHUNK_DEPTH; ++z) {
+            for(uint32_t x = 0; x < world::CHUNK_WIDTH; ++x) {
+                biomes.push_back(static_cast<uint8_t>(chunk.biome_at(static_cast<int>(x),
+                                                                     static_cast<int>(y),
+                                                                     static_cast<int>(z))));
+
+                auto local_sites = chunk.sites_at(static_cast<int>(x),
+                                                  static_cast<int>(y),
+                                                  static_cast<int>(z));
+                std::transform(std::begin(local_sites), std::end(local_sites), std::back_inserter(resources), [x, z](const site& site) {
+                    return networking::resource(x, z, site.type(), site.amount());
+                });
+            }
+        }
     }
-    network.send_to(networking::packet::make(serialized_flyweights, PACKET_SETUP_FLYWEIGHTS), client);
+
+    return networking::world_chunk(chunk.position().x, chunk.position().y, biomes, resources);
+}
+
 }
 
 void authoritative_game::send_map(const client& connecting_client) {
     std::cout << "sending map..." << std::endl;
     std::vector<networking::world_chunk> chunks_to_send;
     chunks_to_send.reserve(std::distance(world.begin(), world.end()));
-    std::transform(std::begin(world), std::end(world), std::back_inserter(chunks_to_send), [&connecting_client](const world_chunk& chunk) {
-        std::vector<uint8_t> biomes;
-        biomes.reserve(world::CHUNK_WIDTH * world::CHUNK_HEIGHT * world::CHUNK_DEPTH);
-
-        std::vector<networking::resource> resources;
-        // SETUP BIOMES
-        for(uint32_t y = 0; y < world::CHUNK_HEIGHT; ++y) {
-            for(uint32_t z = 0; z < world::CHUNK_DEPTH; ++z) {
-                for(uint32_t x = 0; x < world::CHUNK_WIDTH; ++x) {
-                    biomes.push_back(static_cast<uint8_t>(chunk.biome_at(static_cast<int>(x),
-                                                                         static_cast<int>(y),
-                                                                         static_cast<int>(z))));
-
-                    auto local_sites = chunk.sites_at(static_cast<int>(x),
-                                                      static_cast<int>(y),
-                                                      static_cast<int>(z));
-                    std::transform(std::begin(local_sites), std::end(local_sites), std::back_inserter(resources), [x, z](const site* site) {
-                        return networking::resource(x, z, site->type(), site->amount());
-                    });
-                }
-            }
+    std::transform(std::begin(world), std::end(world), std::back_inserter(chunks_to_send), to_network_chunk);
+
+    network.send_to(networking::packet::make(chunks_to_send, PACKET_SETUP_CHUNK), connecting_client.socket);
+}
+
+void authoritative_game::stream_chunks() {
+    const std::vector<world_chunk::position_type> published = world.publish_generated();
+    if(!published.empty()) {
+        std::vector<networking::world_chunk> chunks_to_send;
+        chunks_to_send.reserve(published.size());
+        for(const world_chunk::position_type& pos : published) {
+            pathfinder.invalidate(pos.x, pos.y);
+            chunks_to_send.push_back(to_network_chunk(*world.chunk_at(pos.x, pos.y)));
         }
 
-        return networking::world_chunk(chunk.position().x, chunk.position().y, biomes, resources);
+        // The regions grow with the world, orders toward the new chunks would be rejected otherwise
+        are_regions_stale = true;
+
+        for(const client& c : connected_clients) {
+            network.send_to(networking::packet::make(chunks_to_send, PACKET_SETUP_CHUNK), c.socket);
+        }
+    }
+
+    update_regions();
+
+    // Each chunk holding a unit is looked at once, however many units it holds
+    unit_chunks.clear();
+    for(auto it = units().begin_of_units(); it != units().end_of_units(); ++it) {
+        const glm::vec3 position = it->second->get_position();
+        unit_chunks.emplace_back(static_cast<int>(std::floor(position.x)) / static_cast<int>(world::CHUNK_WIDTH),
+                                 static_cast<int>(std::floor(position.z)) / static_cast<int>(world::CHUNK_DEPTH));
+    }
+
+    std::sort(std::begin(unit_chunks), std::end(unit_chunks), [](const glm::i32vec2& a, const glm::i32vec2& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
     });
+    unit_chunks.erase(std::unique(std::begin(unit_chunks), std::end(unit_chunks)), std::end(unit_chunks));
 
-    network.send_to(networking::packet::make(chunks_to_send, PACKET_SETUP_CHUNK), connecting_client.socket);
+    for(const glm::i32vec2& chunk : unit_chunks) {
+        world.prefetch_around(chunk, PREFETCH_RING);
+    }
+}
+
+void authoritative_game::update_regions() {
+    // The tick keeps the last regions until the build in flight is done, orders toward
+    // chunks published meanwhile are rejected for a few ticks
+    if(regions_build.valid()) {
+        if(regions_build.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        regions_build.get();
+        regions = std::move(*next_regions);
+        next_regions.reset();
+    }
+
+    if(!are_regions_stale) {
+        return;
+    }
+    are_regions_stale = false;
+
+    // The task owns everything it reads, a bit per tile is copied so the world can keep streaming
+    auto walkable = std::make_shared<walkability_map>(world.walkability());
+    next_regions = std::make_shared<reachability_map>();
+    regions_build = push_task(async::make_task([walkable, chunk_count = world.size(), movements = movements, built = next_regions]() {
+        // The bands are labeled on this worker, waiting on tasks of the same pool could starve it
+        auto run_here = [](async::task_executor::task_ptr task) {
+            task->execute();
+            std::promise<async::task_executor::task_ptr> done;
+            done.set_value(std::move(task));
+            return done.get_future();
+        };
+
+        for(movement_class movement : movements) {
+            built->build(*walkable, chunk_count, movement, run_here);
+        }
+    }));
 }
 
 void authoritative_game::on_connection(networking::network_manager::socket_handle handle) {
@@ -369,9 +312,6 @@ void authoritative_game::on_connection(networking::network_manager::socket_handl
     client connected_client(handle, static_cast<uint8_t>(connected_clients.size()));
 
     glm::i32vec2 spawn_position = spawn_chunks[connected_client.id];
-    glm::vec3 starting_position(spawn_position.x * world::CHUNK_WIDTH,
-                                0.f,
-                                spawn_position.y * world::CHUNK_DEPTH);
 
     std::cout << "client #" << connected_client.id << " spawns at " << spawn_position.x << ", " << spawn_position.y << std::endl;
 
@@ -395,8 +335,9 @@ void authoritative_game::on_connection(networking::network_manager::socket_handl
     // TODO: To remove
 
     //make sure unit doesn't spawn in water or inside ressource
-    glm::vec2 availabe_position = find_available_position(world.chunk_at(spawn_chunks[connected_client.id - 1].x, spawn_chunks[connected_client.id - 1].y));
-    
+    glm::vec2 availabe_position = find_available_position(spawn_position);
+    glm::vec3 starting_position(availabe_position.x, 0.f, availabe_position.y);
+
     spawn_unit(connected_client.id, starting_position, availabe_position, 106);
 	spawn_unit(connected_client.id, starting_position, availabe_position, 102);
 	spawn_unit(connected_client.id, starting_position, availabe_position, 102);
@@ -405,32 +346,44 @@ void authoritative_game::on_connection(networking::network_manager::socket_handl
 	spawn_unit(connected_client.id, starting_position, availabe_position, 104);
 }
 
-glm::vec2 authoritative_game::find_available_position(world_chunk* player_chunk)
+glm::vec2 authoritative_game::find_available_position(glm::i32vec2 spawn_chunk) const
 {
-    bool start_position_available = false;
-    glm::vec2 player_start_position{0,0};
-    for (size_t i = 0; i < world.CHUNK_WIDTH; ++i)
-    {
-        for (size_t j = 0; j < world.CHUNK_DEPTH; ++j)
-        {
-            int biome = player_chunk->biome_at(i, 0, j);
-            std::vector<site*> sites = player_chunk->sites_at(i, 0, j);
-            if (biome != BIOME_WATER && !sites.empty() && sites.front()->type() == SITE_NOTHING)
-            {
-                player_start_position = { i,j };
-                start_position_available = true;
-                break;
-            }
-        }
-        if (start_position_available)
-        {
-            break;
+    // The starting units need a free area, the one with the richest surroundings is taken and
+    // the closest to the center of the chunk among equals
+    for(int size = START_AREA_SIZE; size > 0; size /= 2) {
+        const std::vector<glm::i32vec2> spots = world.occupancy().free_spots_in(spawn_chunk.x, spawn_chunk.y, size, size);
+        if(spots.empty()) {
+            continue;
         }
+
+        const glm::vec2 chunk_center((spawn_chunk.x + 0.5f) * world::CHUNK_WIDTH, (spawn_chunk.y + 0.5f) * world::CHUNK_DEPTH);
+        const glm::vec2 half_size(size / 2.f, size / 2.f);
+        auto surroundings_score = [this, size](glm::i32vec2 spot) {
+            return world_scores.score_in(spot.x - START_AREA_SIZE, spot.y - START_AREA_SIZE, size + 2 * START_AREA_SIZE, size + 2 * START_AREA_SIZE);
+        };
+        auto best = std::min_element(std::begin(spots), std::end(spots), [&](glm::i32vec2 a, glm::i32vec2 b) {
+            const double a_score = surroundings_score(a);
+            const double b_score = surroundings_score(b);
+            if(a_score != b_score) {
+                return a_score > b_score;
+            }
+
+            return glm::length(glm::vec2(a) + half_size - chunk_center) < glm::length(glm::vec2(b) + half_size - chunk_center);
+        });
+
+        return glm::vec2(*best) + half_size;
     }
-    return player_start_position;
+
+    std::cerr << "no free tile in spawn chunk " << spawn_chunk.x << ", " << spawn_chunk.y << std::endl;
+    return glm::vec2(spawn_chunk.x * world::CHUNK_WIDTH, spawn_chunk.y * world::CHUNK_DEPTH);
 }
 
 void authoritative_game::spawn_unit(uint8_t owner, glm::vec3 position, glm::vec2 target, int flyweight_id) {
+    if(!has_flyweight(flyweight_id)) {
+        std::cerr << "cannot spawn unit of unknown flyweight " << flyweight_id << std::endl;
+        return;
+    }
+
     std::cout << "spawning unit " << flyweight_id
               << " for player #" << static_cast<int>(owner)
               << " at " << position.x << ", " << position.y << ", " << position.z
@@ -447,22 +400,19 @@ void authoritative_game::spawn_unit(uint8_t owner, glm::vec3 position, glm::vec2
     });
     if(it != std::end(connected_clients)) {
         for(const unit& u : units_to_spawn) {
-            it->known_units.emplace(u.get_id());
+            it->know_unit(u.get_id());
         }
     }
 }
 
 void authoritative_game::broadcast_current_state() {
-    std::for_each(std::begin(connected_clients), std::end(connected_clients), [this](const client& c) {
+    const unit_manager::snapshot_ptr current_state = units().snapshot();
+
+    std::for_each(std::begin(connected_clients), std::end(connected_clients), [this, &current_state](client& c) {
         // Send units known by this client
-        std::vector<unit> updated_units;
-        std::transform(units().begin_of_units(), units().end_of_units(), std::back_inserter(updated_units),
-                       [](const auto &p) {
-                           return *p.second;
-                       });
         std::vector<unit> known_units;
-        known_units.reserve(updated_units.size());
-        std::copy_if(std::begin(updated_units), std::end(updated_units), std::back_inserter(known_units), [&c](const unit& u) {
+        known_units.reserve(current_state->size());
+        std::copy_if(std::begin(*current_state), std::end(*current_state), std::back_inserter(known_units), [&c](const unit& u) {
             return c.known_units.find(u.get_id()) != std::end(c.known_units);
         });
 
@@ -470,14 +420,100 @@ void authoritative_game::broadcast_current_state() {
         if(known_units.size() > 0) {
             network.send_to(networking::packet::make(known_units, PACKET_UPDATE_UNITS), c.socket);
         }
+
+        // The next changes are relative to this state
+        c.clear_unit_changes();
     });
 
 }
 
-void authoritative_game::on_update(frame_duration last_frame) {
-    //static frame_duration acc;
-    std::chrono::milliseconds last_frame_ms = std::chrono::duration_cast<std::chrono::milliseconds>(last_frame);
+void authoritative_game::defer_far_units(float elapsed_seconds) {
+    deferred_units = 0;
+    if(governor.current().far_unit_interval <= 1) {
+        for(auto it = units().begin_of_units(); it != units().end_of_units(); ++it) {
+            it->second->undefer();
+        }
+        return;
+    }
+
+    for(auto& positions : player_positions) {
+        positions.second.clear();
+    }
+    for(auto it = units().begin_of_units(); it != units().end_of_units(); ++it) {
+        player_positions[unit_id(it->second->get_id()).player_id].emplace_back(it->second->get_position().x, it->second->get_position().z);
+    }
 
+    // A player without units left keeps an empty grid
+    for(const auto& positions : player_positions) {
+        auto grid = player_units.emplace(positions.first, collision::spatial_grid(NEAR_PLAYER_DISTANCE)).first;
+        grid->second.build(positions.second);
+    }
+
+    for(auto it = units().begin_of_units(); it != units().end_of_units(); ++it) {
+        unit* u = it->second;
+        const uint8_t owner = unit_id(u->get_id()).player_id;
+        const glm::vec2 position(u->get_position().x, u->get_position().z);
+
+        // Units close to a unit of another player keep moving every tick, their own army does not count
+        bool is_near_player = false;
+        for(const auto& grid : player_units) {
+            std::array<collision::spatial_grid::index_type, 1> nearest;
+            if(grid.first != owner && grid.second.k_nearest(position, NEAR_PLAYER_DISTANCE, nearest, [](collision::spatial_grid::index_type) {
+                return true;
+            }) > 0) {
+                is_near_player = true;
+                break;
+            }
+        }
+
+        if(is_near_player || governor.is_far_unit_tick(u->get_id())) {
+            u->undefer();
+        }
+        else {
+            u->defer(elapsed_seconds);
+            ++deferred_units;
+        }
+    }
+}
+
+void authoritative_game::resolve_combat(float elapsed_seconds) {
+    fighters.clear();
+    for(auto it = units().begin_of_units(); it != units().end_of_units(); ++it) {
+        const unit* u = it->second;
+
+        // Deferred units still fight, only their movement is throttled
+        fighters.push_back(gameplay::combatant{u->get_id(), unit_id(u->get_id()).player_id,
+                                               glm::vec2(u->get_position().x, u->get_position().z),
+                                               &units().stats_of(*u), u->health(), u->attack_cooldown()});
+    }
+
+    combat.update(fighters, elapsed_seconds, [this](async::task_executor::task_ptr task) {
+        return push_task(std::move(task));
+    });
+
+    // Survivors kept the order of the units
+    auto survivor = std::begin(fighters);
+    for(auto it = units().begin_of_units(); it != units().end_of_units() && survivor != std::end(fighters); ++it) {
+        unit* u = it->second;
+        if(u->get_id() == survivor->id) {
+            u->set_health(survivor->health);
+            u->set_attack_cooldown(survivor->cooldown);
+            ++survivor;
+        }
+    }
+
+    killed_units += combat.killed().size();
+    for(uint32_t dead : combat.killed()) {
+        unit_paths.cancel(dead);
+    }
+    units().remove_all(combat.killed());
+}
+
+bool authoritative_game::wait_for_packets_until(time_point deadline) {
+    return network.wait_packets_until(deadline);
+}
+
+void authoritative_game::process_packets() {
     auto received_packets = network.poll_packets();
     for(const std::pair<networking::network_manager::socket_handle, networking::packet>& packet : received_packets) {
         auto packet_socket = packet.first;
@@ -497,7 +533,17 @@ void authoritative_game::on_update(frame_duration last_frame) {
 
                         // it can move this unit
                         if(id.player_id == it->id) {
-                            static_cast<unit*>(units().get(update.unit_id))->set_target_position(update.new_target);
+                            unit* u = static_cast<unit*>(units().get(update.unit_id));
+                            if(u) {
+                                const glm::i32vec2 from_tile(static_cast<int>(std::floor(u->get_position().x)), static_cast<int>(std::floor(u->get_position().z)));
+                                const glm::i32vec2 target_tile(static_cast<int>(std::floor(update.new_target.x)), static_cast<int>(std::floor(update.new_target.y)));
+
+                                // Orders toward another island are rejected before searching a path
+                                const movement_class movement = units().stats_of(*u).movement;
+                                if(regions.can_reach(movement, from_tile, target_tile)) {
+                                    unit_paths.order(*u, movement, update.new_target);
+                                }
+                            }
                         }
                     }
                 }
@@ -507,73 +553,59 @@ void authoritative_game::on_update(frame_duration last_frame) {
             }
         }
     }
+}
 
-    auto update_task = push_task(std::make_unique<task::update_units>(units(), world, last_frame_ms.count() / 1000.0f));
+void authoritative_game::on_update(frame_duration last_frame) {
+    game_time::highres_clock tick_clock;
+    const float elapsed_seconds = std::chrono::duration<float>(last_frame).count();
+
+    process_packets();
+    stream_chunks();
+
+    unit_paths.advance(units());
+    defer_far_units(elapsed_seconds);
+
+    const std::vector<glm::vec2>& pushes = separate_units();
+    auto update_task = push_task(std::make_unique<task::update_units>(units(), world, elapsed_seconds, pushes));
 
     update_task.wait();
+    resolve_combat(elapsed_seconds);
+    units().publish_snapshot();
 
     // Wait that units moves to update visibility
-    std::vector<async::task_executor::task_future> update_visibility;
-    for(client& c : connected_clients) {
-        update_visibility.push_back(push_task(std::make_unique<task::update_player_visibility>(c.id, c.map_visibility, units())));
-    }
-
-    for(async::task_executor::task_future& future : update_visibility) {
-        auto visiblity_ptr = future.get();
-        auto visibility_task_ptr = static_cast<task::update_player_visibility*>(visiblity_ptr.get());
-        if(visibility_task_ptr) {
-            uint8_t player_id = visibility_task_ptr->get_player();
-            auto it = std::find_if(std::begin(connected_clients), std::end(connected_clients), [player_id](const client& c) {
-               return c.id == player_id;
-            });
-
-            if(it != std::end(connected_clients)) {
-                it->map_visibility = visibility_task_ptr->visibility();
-            }
+    if(governor.is_visibility_tick()) {
+        std::vector<async::task_executor::task_future> update_visibility;
+        for(client& c : connected_clients) {
+            update_visibility.push_back(push_task(std::make_unique<task::update_player_visibility>(c.id, c.visibility_changes, c.map_visibility, c.next_visibility, units().snapshot(), unit_flyweights())));
         }
-    }
-
-    // Update known chunks of every clients
-    for(client& c : connected_clients) {
-        // The players always knows about it's units
-        c.known_units.clear();
 
-        std::vector<unit*> players_units;
-        units().units_of(c.id, std::back_inserter(players_units));
-        std::vector<uint32_t> unit_ids;
-        unit_ids.resize(players_units.size());
-        std::transform(std::begin(players_units), std::end(players_units), std::begin(unit_ids), [](const unit* u) {
-            return u->get_id();
-        });
-        c.known_units.insert(std::begin(unit_ids), std::end(unit_ids));
-
-        for(std::size_t y = 0; y < c.map_visibility.height(); ++y) {
-            for(std::size_t x = 0; x < c.map_visibility.width(); ++x) {
-                const int chunk_x = x / world::CHUNK_WIDTH;
-                const int chunk_z = y / world::CHUNK_DEPTH;
-
-                if(c.map_visibility.at(x, y) == visibility::visible) {
-                    std::vector<unit*> units_in_tile;
-                    units().units_in(collision::aabb_shape(glm::vec2(x, y), 1.0f), std::back_inserter(units_in_tile), [](unit*)
-                    {
-                        return true;
-                    });
-
-                    std::vector<uint32_t> units_ids(units_in_tile.size(), 0);
-                    std::transform(std::begin(units_in_tile), std::end(units_in_tile), std::begin(units_ids), [](const unit* u) {
-                       return u->get_id();
-                    });
-
-                    c.known_units.insert(std::begin(units_ids), std::end(units_ids));
+        for(async::task_executor::task_future& future : update_visibility) {
+            auto visiblity_ptr = future.get();
+            auto visibility_task_ptr = static_cast<task::update_player_visibility*>(visiblity_ptr.get());
+            if(visibility_task_ptr) {
+                uint8_t player_id = visibility_task_ptr->get_player();
+                auto it = std::find_if(std::begin(connected_clients), std::end(connected_clients), [player_id](const client& c) {
+                   return c.id == player_id;
+                });
+
+                if(it != std::end(connected_clients)) {
+                    it->map_visibility.swap(it->next_visibility);
                 }
             }
         }
+
+        // Update the units known by every clients
+        const unit_manager::snapshot_ptr current_state = units().snapshot();
+        for(client& c : connected_clients) {
+            c.update_known_units(*current_state);
+        }
     }
 
-    // Broadcast current state every seconds
-    if(world_state_sync_clock.elapsed_time<std::chrono::milliseconds>() >= std::chrono::milliseconds(250)) {
+    // Broadcast current state, less often when the server is late
+    const std::chrono::milliseconds broadcast_interval = governor.current().broadcast_interval;
+    if(world_state_sync_clock.elapsed_time<std::chrono::milliseconds>() >= broadcast_interval) {
         broadcast_current_state();
-        world_state_sync_clock.substract(std::chrono::milliseconds(250));
+        world_state_sync_clock.restart();
     }
 
     for (auto& u : removed_client)
@@ -588,6 +620,25 @@ void authoritative_game::on_update(frame_duration last_frame) {
         }
     }
     removed_client.clear();
+
+    if(governor.record(tick_clock.elapsed_time<std::chrono::microseconds>())) {
+        const simulation_governor::level_of_detail& level = governor.current();
+        std::cout << "simulation level " << governor.level()
+                  << " (average tick " << governor.average_cost_ms() << " ms, budget " << TICK_BUDGET.count() << " ms):"
+                  << " visibility every " << level.visibility_interval << " ticks,"
+                  << " far units every " << level.far_unit_interval << " ticks,"
+                  << " broadcast every " << level.broadcast_interval.count() << " ms" << std::endl;
+    }
+}
+
+authoritative_game::statistics authoritative_game::stats() const noexcept {
+    statistics current;
+    current.simulation_level = governor.level();
+    current.average_tick_ms = governor.average_cost_ms();
+    current.deferred_units = deferred_units;
+    current.killed_units = killed_units;
+
+    return current;
 }
 
 void authoritative_game::on_release() {
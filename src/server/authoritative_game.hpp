@@ -2,43 +2,108 @@
 #define MMAP_DEMO_AUTHORITATIVE_GAME_HPP
 
 #include "client.hpp"
+#include "simulation_governor.hpp"
 #include "../common/game/base_game.hpp"
+#include "../common/game/combat_system.hpp"
+#include "../common/collision/spatial_grid.hpp"
 #include "../common/world/world.hpp"
+#include "../common/world/reachability_map.hpp"
+#include "../common/world/score_table.hpp"
+#include "../common/pathfinding/hierarchical_pathfinder.hpp"
+#include "../common/pathfinding/path_follower.hpp"
 #include "../common/networking/network_manager.hpp"
 #include "../common/networking/packet.hpp"
 #include "../common/time/clock.hpp"
+#include "../common/time/fixed_timestep.hpp"
 #include "../common/memory/static_vector.hpp"
 
+#include <memory>
+#include <unordered_map>
+
 class authoritative_game : public gameplay::base_game {
     static const uint8_t MAX_CLIENT_COUNT = 2;
+    static constexpr std::chrono::milliseconds TICK_BUDGET{25};
+    static const int START_AREA_SIZE = 4;
+    static const int WORLD_SIZE = 20;
+    static const int PREFETCH_RING = 2;
+
+    // Units farther than this from every unit of the other players are far from them, in tiles.
+    // Wider than the longest attack range so a unit an enemy can reach is never deferred
+    static constexpr float NEAR_PLAYER_DISTANCE = 32.f;
+    const uint32_t seed;
+    const map_choice chosen_map;
     infinite_world world;
+    score_table world_scores;
+    pathfinding::hierarchical_pathfinder pathfinder;
+    pathfinding::path_follower unit_paths;
+    reachability_map regions;
+
+    // Relabeled by a task on a copy of the walkable tiles when chunks stream in, swapped in once done
+    std::shared_ptr<reachability_map> next_regions;
+    async::task_executor::task_future regions_build;
+    bool are_regions_stale = false;
+    gameplay::combat_system combat;
+    std::vector<gameplay::combatant> fighters;
+    std::vector<movement_class> movements;
+    std::vector<glm::i32vec2> unit_chunks;
     std::vector<client> connected_clients;
     std::mutex clients_mutex;
     networking::network_manager network;
     game_time::highres_clock world_state_sync_clock;
-    glm::i32vec2 spawn_chunks[2];
+    simulation_governor governor;
+
+    // Units of each player, a unit is only looked up in the grids of the other players
+    std::unordered_map<uint8_t, std::vector<glm::vec2>> player_positions;
+    std::unordered_map<uint8_t, collision::spatial_grid> player_units;
+    std::size_t deferred_units = 0;
+    uint64_t killed_units = 0;
+    std::vector<glm::i32vec2> spawn_chunks;
     static_vector<uint8_t, 2> removed_client;
 
     void load_flyweights();
     void load_assets();
-    void find_spawn_chunks();
     void generate_world();
     void setup_listener();
 
-    glm::vec2 find_available_position(world_chunk* player_chunk);
+    glm::vec2 find_available_position(glm::i32vec2 spawn_chunk) const;
     void send_flyweights(networking::network_manager::socket_handle client);
     void send_map(const client& connecting_client);
+    void stream_chunks();
+    void update_regions();
     void on_connection(networking::network_manager::socket_handle handle);
     void spawn_unit(uint8_t owner, glm::vec3 position, glm::vec2 target, int flyweight_id);
 
+    void defer_far_units(float elapsed_seconds);
     void broadcast_current_state();
+    void resolve_combat(float elapsed_seconds);
 
 public:
+    using time_point = game_time::fixed_timestep::time_point;
+
+    struct statistics {
+        // Level of detail of the governor, 0 is full fidelity
+        std::size_t simulation_level = 0;
+        double average_tick_ms = 0.0;
+
+        // Units moved at a lower rate on the last tick
+        std::size_t deferred_units = 0;
+
+        // Units killed since the server started
+        uint64_t killed_units = 0;
+    };
+
     authoritative_game();
     authoritative_game(map_choice chosen_map);
+    authoritative_game(map_choice chosen_map, uint32_t seed);
     void on_init() override;
     void on_update(frame_duration last_frame) override;
     void on_release() override;
+
+    // Orders are applied as soon as they arrive, between the simulation steps
+    bool wait_for_packets_until(time_point deadline);
+    void process_packets();
+
+    statistics stats() const noexcept;
 };
 
 #endif //MMAP_DEMO_AUTHORITATIVE_GAME_HPP
@@ -1,13 +1,85 @@
 #include "client.hpp"
 #include "../common/world/world.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// A change cancels the opposite one still pending
+void record_change(std::vector<uint32_t>& changes, std::vector<uint32_t>& opposite_changes, uint32_t unit_id) {
+    auto it = std::find(opposite_changes.begin(), opposite_changes.end(), unit_id);
+    if(it != opposite_changes.end()) {
+        opposite_changes.erase(it);
+    }
+    else {
+        changes.push_back(unit_id);
+    }
+}
+
+}
+
 client::client(networking::network_manager::socket_handle socket, uint8_t id)
 : socket(socket)
 , id(id)
-, map_visibility(world::CHUNK_WIDTH * 20, world::CHUNK_DEPTH * 20) {
+, map_visibility(world::CHUNK_WIDTH * 20, world::CHUNK_DEPTH * 20)
+, next_visibility(world::CHUNK_WIDTH * 20, world::CHUNK_DEPTH * 20)
+, visibility_changes(world::CHUNK_WIDTH * 20, world::CHUNK_DEPTH * 20) {
 
 }
 
 bool client::operator==(const client& other) const noexcept {
     return id == other.id;
-}
\ No newline at end of file
+}
+
+void client::update_known_units(const unit_snapshot& units) {
+    std::size_t still_known = 0;
+    for(const unit& u : units) {
+        const int x = static_cast<int>(std::floor(u.get_position().x));
+        const int z = static_cast<int>(std::floor(u.get_position().z));
+        // Most units stand in chunks where nothing is visible
+        const bool is_on_visible_tile = x >= 0 && z >= 0
+                                     && map_visibility.is_chunk_visible(x / world::CHUNK_WIDTH, z / world::CHUNK_DEPTH)
+                                     && static_cast<std::size_t>(x) < map_visibility.width()
+                                     && static_cast<std::size_t>(z) < map_visibility.height()
+                                     && map_visibility.is_visible(x, z);
+
+        const bool is_known = unit_id(u.get_id()).player_id == id || is_on_visible_tile;
+        auto it = known_units.find(u.get_id());
+        if(is_known) {
+            if(it == known_units.end()) {
+                known_units.insert(u.get_id());
+                record_change(entered_units, left_units, u.get_id());
+            }
+            ++still_known;
+        }
+        else if(it != known_units.end()) {
+            known_units.erase(it);
+            record_change(left_units, entered_units, u.get_id());
+        }
+    }
+
+    // Some known units are not in the world anymore
+    if(known_units.size() > still_known) {
+        for(auto it = known_units.begin(); it != known_units.end();) {
+            if(!units.find(*it)) {
+                record_change(left_units, entered_units, *it);
+                it = known_units.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
+
+void client::know_unit(uint32_t unit_id) {
+    if(known_units.insert(unit_id).second) {
+        record_change(entered_units, left_units, unit_id);
+    }
+}
+
+void client::clear_unit_changes() noexcept {
+    entered_units.clear();
+    left_units.clear();
+}
@@ -4,10 +4,13 @@
 #include "../common/networking/network_manager.hpp"
 #include "../common/util/vec_hash.hpp"
 #include "../common/world/visibility_map.hpp"
+#include "../common/world/visibility_tracker.hpp"
+#include "../common/actor/unit_snapshot.hpp"
 
 #include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <glm/glm.hpp>
 
 struct client {
@@ -17,12 +20,28 @@ struct client {
     // The units this player knows about
     std::unordered_set<uint32_t> known_units;
 
+    // Changes of known_units since the last broadcast, a unit that came back in between is in neither
+    std::vector<uint32_t> entered_units;
+    std::vector<uint32_t> left_units;
+
     // Holds this player visibility
     visibility_map map_visibility;
 
+    // Written by the visibility task then swapped with map_visibility
+    visibility_map next_visibility;
+    visibility_tracker visibility_changes;
+
     client(networking::network_manager::socket_handle socket, uint8_t id);
 
 	client() = delete;
+
+    // Knows its own units and those standing on a visible tile
+    void update_known_units(const unit_snapshot& units);
+
+    // A unit known before the next update, such as a spawned one
+    void know_unit(uint32_t unit_id);
+    void clear_unit_changes() noexcept;
+
     bool operator==(const client& other) const noexcept;
 };
 
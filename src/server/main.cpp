@@ -1,4 +1,5 @@
 #include "../common/time/clock.hpp"
+#include "../common/time/fixed_timestep.hpp"
 
 #include "authoritative_game.hpp"
 
@@ -11,10 +12,16 @@
 #endif
 
 #include <iostream>
+#include <chrono>
 #include <csignal>
+#include <cstdlib>
 
 namespace {
     volatile std::sig_atomic_t g_signal_status = 0;
+
+    const std::chrono::milliseconds SIMULATION_STEP(30);
+    const uint32_t MAX_STEPS_PER_FRAME = 4;
+    const std::chrono::seconds STATS_INTERVAL(10);
 }
 
 extern "C" void sign_handler(int signo) {
@@ -61,7 +68,14 @@ int main(int argc, char* argv[]) {
            chosen_map = map_choice::RIVER_MAP;
        }
     }
-    authoritative_game game(chosen_map);
+
+    // A fixed seed lets the server map the world baked for it
+    uint32_t seed = static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    if (argc >= 3 && argv[2] != NULL)
+    {
+        seed = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    }
+    authoritative_game game(chosen_map, seed);
     game.init();
 
     if(std::signal(SIGTERM, sign_handler) == SIG_ERR) {
@@ -74,12 +88,41 @@ int main(int argc, char* argv[]) {
     }
 #endif
 
-    game_time::highres_clock frame_time;
+    // The simulation always moves by the same step, late frames catch up with extra steps
+    game_time::fixed_timestep timestep(SIMULATION_STEP, MAX_STEPS_PER_FRAME);
+    game_time::highres_clock stats_clock;
     while(game.is_running() && g_signal_status == 0) {
-        const auto last_frame_duration = frame_time.elapsed_time<gameplay::base_game::frame_duration>();
-        frame_time.restart();
-        game.update(last_frame_duration);
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        const auto deadline = timestep.next_step_at();
+        while(game.wait_for_packets_until(deadline - game_time::fixed_timestep::SPIN_MARGIN)) {
+            game.process_packets();
+        }
+        game_time::fixed_timestep::sleep_until(deadline);
+
+        const uint32_t due_steps = timestep.advance(game_time::fixed_timestep::clock_type::now());
+        for(uint32_t i = 0; i < due_steps && game.is_running(); ++i) {
+            const auto step_start = game_time::fixed_timestep::clock_type::now();
+            game.update(std::chrono::duration_cast<gameplay::base_game::frame_duration>(timestep.step()));
+            timestep.record_step(game_time::fixed_timestep::clock_type::now() - step_start);
+        }
+
+        if(stats_clock.elapsed_time<std::chrono::seconds>() >= STATS_INTERVAL) {
+            const game_time::fixed_timestep::statistics stats = timestep.stats();
+            std::cout << "ticks: " << stats.steps
+                      << ", catch-up " << stats.catch_up_steps
+                      << ", overruns " << stats.overruns
+                      << ", dropped " << stats.dropped_steps
+                      << ", median " << stats.median_us << " us"
+                      << ", p99 " << stats.p99_us << " us"
+                      << ", max " << stats.max_us << " us" << std::endl;
+
+            const authoritative_game::statistics game_stats = game.stats();
+            std::cout << "simulation level " << game_stats.simulation_level
+                      << ", average tick " << game_stats.average_tick_ms << " ms"
+                      << ", deferred units " << game_stats.deferred_units
+                      << ", killed units " << game_stats.killed_units << std::endl;
+            timestep.reset_stats();
+            stats_clock.restart();
+        }
     }
     // If exiting game loop because of signal, call stop
     if(game.is_running()) {
@@ -0,0 +1,68 @@
+#include "simulation_governor.hpp"
+
+const std::array<simulation_governor::level_of_detail, simulation_governor::LEVEL_COUNT> simulation_governor::LEVELS = {{
+    {1, 1, std::chrono::milliseconds(250)},
+    {2, 2, std::chrono::milliseconds(250)},
+    {4, 4, std::chrono::milliseconds(500)},
+    {8, 8, std::chrono::milliseconds(1000)}
+}};
+
+constexpr double simulation_governor::RESTORE_RATIO;
+
+simulation_governor::simulation_governor(std::chrono::microseconds budget) noexcept
+: budget_(budget) {
+
+}
+
+bool simulation_governor::record(std::chrono::microseconds tick_cost) noexcept {
+    // Smooths the cost so a single slow tick does not change the level
+    const double SMOOTHING = 0.2;
+    average_cost_us += (tick_cost.count() - average_cost_us) * SMOOTHING;
+    ++tick_;
+
+    const double budget_us = static_cast<double>(budget_.count());
+    over_budget_ticks = average_cost_us > budget_us ? over_budget_ticks + 1 : 0;
+    under_budget_ticks = average_cost_us < budget_us * RESTORE_RATIO ? under_budget_ticks + 1 : 0;
+
+    if(over_budget_ticks >= DEGRADE_AFTER && level_ + 1 < LEVEL_COUNT) {
+        ++level_;
+    }
+    else if(under_budget_ticks >= RESTORE_AFTER && level_ > 0) {
+        --level_;
+    }
+    else {
+        return false;
+    }
+
+    over_budget_ticks = 0;
+    under_budget_ticks = 0;
+    return true;
+}
+
+std::size_t simulation_governor::level() const noexcept {
+    return level_;
+}
+
+const simulation_governor::level_of_detail& simulation_governor::current() const noexcept {
+    return LEVELS[level_];
+}
+
+uint64_t simulation_governor::tick() const noexcept {
+    return tick_;
+}
+
+bool simulation_governor::is_visibility_tick() const noexcept {
+    return tick_ % current().visibility_interval == 0;
+}
+
+bool simulation_governor::is_far_unit_tick(uint32_t unit_id) const noexcept {
+    return (tick_ + unit_id) % current().far_unit_interval == 0;
+}
+
+std::chrono::microseconds simulation_governor::budget() const noexcept {
+    return budget_;
+}
+
+double simulation_governor::average_cost_ms() const noexcept {
+    return average_cost_us / 1000.0;
+}
@@ -0,0 +1,61 @@
+#ifndef MMAP_DEMO_SIMULATION_GOVERNOR_HPP
+#define MMAP_DEMO_SIMULATION_GOVERNOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// Measures the cost of the server ticks against a budget. When the ticks overrun it,
+// the simulation steps down one level of detail at a time, and steps back up once
+// the ticks leave enough headroom
+class simulation_governor {
+public:
+    struct level_of_detail {
+        // Visibility and known units are refreshed once every this many ticks
+        uint32_t visibility_interval;
+
+        // Units far from the units of every other player move once every this many ticks
+        uint32_t far_unit_interval;
+
+        std::chrono::milliseconds broadcast_interval;
+    };
+
+    static const std::size_t LEVEL_COUNT = 4;
+
+    // Consecutive ticks needed before changing the level
+    static const uint32_t DEGRADE_AFTER = 10;
+    static const uint32_t RESTORE_AFTER = 60;
+
+    // The average cost must drop under this part of the budget to restore a level
+    static constexpr double RESTORE_RATIO = 0.5;
+private:
+    static const std::array<level_of_detail, LEVEL_COUNT> LEVELS;
+
+    std::chrono::microseconds budget_;
+    double average_cost_us = 0.0;
+    std::size_t level_ = 0;
+    uint32_t over_budget_ticks = 0;
+    uint32_t under_budget_ticks = 0;
+    uint64_t tick_ = 0;
+
+public:
+    explicit simulation_governor(std::chrono::microseconds budget) noexcept;
+
+    // Records the cost of the tick that just ended, returns true when the level changed
+    bool record(std::chrono::microseconds tick_cost) noexcept;
+
+    // 0 is full fidelity
+    std::size_t level() const noexcept;
+    const level_of_detail& current() const noexcept;
+
+    uint64_t tick() const noexcept;
+    bool is_visibility_tick() const noexcept;
+
+    // Far units are spread over the ticks so the same share of them moves every tick
+    bool is_far_unit_tick(uint32_t unit_id) const noexcept;
+
+    std::chrono::microseconds budget() const noexcept;
+    double average_cost_ms() const noexcept;
+};
+
+#endif //MMAP_DEMO_SIMULATION_GOVERNOR_HPP
@@ -0,0 +1,71 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+namespace benchmark {
+
+arguments::arguments(int argc, char* argv[]) {
+    for(int i = 0; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const std::string value = argv[i + 1];
+
+        if(name == "--size") {
+            map_size = std::stoul(value);
+        }
+        else if(name == "--seed") {
+            seed = static_cast<uint32_t>(std::stoul(value));
+        }
+        else if(name == "--iterations") {
+            iterations = std::stoul(value);
+        }
+        else if(name == "--map") {
+            if(value == "island") map = map_choice::ISLAND_MAP;
+            else if(value == "lake") map = map_choice::LAKE_MAP;
+            else if(value == "river") map = map_choice::RIVER_MAP;
+            else map = map_choice::PLAIN_MAP;
+        }
+        else {
+            std::cerr << "unknown argument '" << name << "'" << std::endl;
+        }
+    }
+}
+
+latency::latency(std::vector<double> samples_us) {
+    if(samples_us.empty()) {
+        return;
+    }
+
+    std::sort(std::begin(samples_us), std::end(samples_us));
+    average_us = std::accumulate(std::begin(samples_us), std::end(samples_us), 0.0) / samples_us.size();
+    median_us = samples_us[samples_us.size() / 2];
+    p99_us = samples_us[std::min(samples_us.size() - 1, samples_us.size() * 99 / 100)];
+    max_us = samples_us.back();
+}
+
+void generate(infinite_world& w, std::size_t map_size) {
+    for(std::size_t x = 0; x < map_size; ++x) {
+        for(std::size_t z = 0; z < map_size; ++z) {
+            w.generate_at(static_cast<int>(x), static_cast<int>(z));
+        }
+    }
+}
+
+void report(const std::string& name, const latency& measured) {
+    std::cout << "  " << name
+              << ": avg " << measured.average_us << " us"
+              << ", median " << measured.median_us << " us"
+              << ", p99 " << measured.p99_us << " us"
+              << ", max " << measured.max_us << " us" << std::endl;
+}
+
+void report(const std::string& name, double value, const std::string& unit) {
+    std::cout << "  " << name << ": " << value << " " << unit << std::endl;
+}
+
+void report_memory(const std::string& name, std::size_t bytes) {
+    report(name, bytes / 1024.0, "KiB");
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef MMAP_DEMO_BENCHMARK_HPP
+#define MMAP_DEMO_BENCHMARK_HPP
+
+#include "../../src/common/world/world.hpp"
+#include "../../src/common/world/world_generator.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+struct arguments {
+    std::size_t map_size = 20;
+    uint32_t seed = 42;
+    std::size_t iterations = 1000;
+    map_choice map = map_choice::PLAIN_MAP;
+
+    arguments(int argc, char* argv[]);
+};
+
+struct latency {
+    double average_us = 0.0;
+    double median_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+
+    explicit latency(std::vector<double> samples_us);
+};
+
+void generate(infinite_world& w, std::size_t map_size);
+
+void report(const std::string& name, const latency& measured);
+void report(const std::string& name, double value, const std::string& unit);
+void report_memory(const std::string& name, std::size_t bytes);
+
+// Every scenario
+int pathfinding(const arguments& args);
+int combat(const arguments& args);
+int crowd(const arguments& args);
+int sites(const arguments& args);
+int collision(const arguments& args);
+int visibility(const arguments& args);
+int generation(const arguments& args);
+int storage(const arguments& args);
+
+}
+
+#endif //MMAP_DEMO_BENCHMARK_HPP
@@ -0,0 +1,107 @@
+#include "benchmark.hpp"
+#include "../../src/common/collision/collision_detector.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace benchmark {
+
+namespace {
+
+const std::size_t CIRCLE_COUNT = 100000;
+const float MAP_SIZE = 640.f;
+
+template<typename Shape>
+void run(const std::string& name, const std::vector<Shape>& shapes, const std::vector<collision::circle_shape>& circles, const collision::circle_batch& batch) {
+    std::vector<double> loop_samples;
+    std::vector<double> scalar_samples;
+    std::vector<double> batch_samples;
+    std::vector<double> compact_samples;
+    std::size_t mismatch_count = 0;
+    std::size_t hit_count = 0;
+
+    std::vector<bool> loop_hits(circles.size());
+    collision::hit_mask scalar_hits;
+    collision::hit_mask batch_hits;
+    std::vector<uint32_t> indices;
+
+    for(const Shape& shape : shapes) {
+        // One pair at a time, as the queries of the unit manager did
+        game_time::highres_clock loop_clock;
+        for(std::size_t i = 0; i < circles.size(); ++i) {
+            loop_hits[i] = collision::detect(circles[i], shape);
+        }
+        loop_samples.push_back(loop_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock scalar_clock;
+        collision::detect_scalar(shape, batch, scalar_hits);
+        scalar_samples.push_back(scalar_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock batch_clock;
+        collision::detect(shape, batch, batch_hits);
+        batch_samples.push_back(batch_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock compact_clock;
+        hit_count += collision::compact(batch_hits, indices);
+        compact_samples.push_back(compact_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        if(scalar_hits != batch_hits) {
+            ++mismatch_count;
+        }
+
+        // The pairwise test takes a square root, only a different count is reported
+        std::size_t loop_count = 0;
+        for(bool is_hit : loop_hits) {
+            loop_count += is_hit ? 1 : 0;
+        }
+        if(loop_count != indices.size()) {
+            ++mismatch_count;
+        }
+    }
+
+    std::cout << name << std::endl;
+    report("pairwise loop", latency(loop_samples));
+    report("batch scalar", latency(scalar_samples));
+    report(std::string("batch ") + collision::batch_instruction_set(), latency(batch_samples));
+    report("compact indices", latency(compact_samples));
+    report("hits per query", static_cast<double>(hit_count) / shapes.size(), "circles");
+    report("mismatching queries", static_cast<double>(mismatch_count), "queries");
+}
+
+}
+
+int collision(const arguments& args) {
+    std::cout << "collision queries against " << CIRCLE_COUNT << " circles" << std::endl;
+
+    std::mt19937 engine(args.seed);
+    std::uniform_real_distribution<float> position_distribution(0.f, MAP_SIZE);
+    std::uniform_real_distribution<float> radius_distribution(0.2f, 1.2f);
+
+    std::vector<collision::circle_shape> circles;
+    collision::circle_batch batch;
+    circles.reserve(CIRCLE_COUNT);
+    batch.reserve(CIRCLE_COUNT);
+    for(std::size_t i = 0; i < CIRCLE_COUNT; ++i) {
+        circles.emplace_back(glm::vec2(position_distribution(engine), position_distribution(engine)), radius_distribution(engine));
+        batch.push_back(circles.back());
+    }
+
+    std::vector<glm::vec2> points;
+    std::vector<collision::circle_shape> areas;
+    std::vector<collision::aabb_shape> selections;
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        const glm::vec2 center(position_distribution(engine), position_distribution(engine));
+        points.push_back(center);
+        areas.emplace_back(center, 8.f);
+        selections.emplace_back(center, 24.f, 14.f);
+    }
+
+    run("point", points, circles, batch);
+    run("circle of radius 8", areas, circles, batch);
+    run("box of 24x14", selections, circles, batch);
+
+    return 0;
+}
+
+}
@@ -0,0 +1,87 @@
+#include "benchmark.hpp"
+#include "../../src/common/game/combat_system.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace benchmark {
+
+namespace {
+
+const std::size_t UNITS_PER_SIDE = 5000;
+const float TICK_SECONDS = 1.f / 30.f;
+
+// Reference: every attacker scans every other fighter
+std::size_t pairwise_targets(const std::vector<gameplay::combatant>& fighters) {
+    std::size_t attacks = 0;
+    for(const gameplay::combatant& attacker : fighters) {
+        float best_distance = attacker.stats->range * attacker.stats->range;
+        bool has_target = false;
+        for(const gameplay::combatant& other : fighters) {
+            const glm::vec2 diff = other.position - attacker.position;
+            const float distance = diff.x * diff.x + diff.y * diff.y;
+            if(other.owner != attacker.owner && distance <= best_distance) {
+                best_distance = distance;
+                has_target = true;
+            }
+        }
+
+        attacks += has_target ? 1 : 0;
+    }
+
+    return attacks;
+}
+
+}
+
+int combat(const arguments& args) {
+    std::cout << "combat of " << UNITS_PER_SIDE << " vs " << UNITS_PER_SIDE << " units" << std::endl;
+
+    const unit_stats melee{1.f, 3.f, 1.f, 1.5f, 1.f, 100, 10, 1, 0};
+    const unit_stats archer{1.f, 10.f, 1.f, 10.f, 1.f, 60, 6, 0, 0};
+
+    // Both armies overlap on a band in the middle
+    std::mt19937 engine(args.seed);
+    std::uniform_real_distribution<float> z_distribution(0.f, 200.f);
+    std::vector<gameplay::combatant> fighters;
+    fighters.reserve(UNITS_PER_SIDE * 2);
+    for(uint8_t side = 0; side < 2; ++side) {
+        std::uniform_real_distribution<float> x_distribution(side * 100.f, side * 100.f + 120.f);
+        for(std::size_t i = 0; i < UNITS_PER_SIDE; ++i) {
+            const uint32_t id = static_cast<uint32_t>(fighters.size());
+            fighters.push_back(gameplay::combatant{id, side, glm::vec2(x_distribution(engine), z_distribution(engine)),
+                                                   i % 4 == 0 ? &archer : &melee, i % 4 == 0 ? archer.max_health : melee.max_health, 0.f});
+        }
+    }
+
+    game_time::highres_clock pairwise_clock;
+    const std::size_t pairwise_attacks = pairwise_targets(fighters);
+    report("pairwise scan (1 tick)", pairwise_clock.elapsed_time<std::chrono::microseconds>().count() / 1000.0, "ms");
+    report("attackers in range", static_cast<double>(pairwise_attacks), "");
+
+    async::task_executor executor(std::max(1u, std::thread::hardware_concurrency()));
+    auto push = [&executor](async::task_executor::task_ptr task) {
+        return executor.push(std::move(task));
+    };
+
+    gameplay::combat_system combat;
+    std::vector<double> tick_samples;
+    std::size_t killed_count = 0;
+    for(std::size_t i = 0; i < args.iterations && !fighters.empty(); ++i) {
+        game_time::highres_clock tick_clock;
+        combat.update(fighters, TICK_SECONDS, push);
+        tick_samples.push_back(tick_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        killed_count += combat.killed().size();
+    }
+
+    report("combat tick", latency(tick_samples));
+    report("ticks", static_cast<double>(tick_samples.size()), "");
+    report("killed", static_cast<double>(killed_count), "units");
+
+    return 0;
+}
+
+}
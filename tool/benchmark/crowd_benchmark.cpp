@@ -0,0 +1,122 @@
+#include "benchmark.hpp"
+#include "../../src/common/game/separation_system.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace benchmark {
+
+namespace {
+
+const float AGENT_RADIUS = 0.5f;
+const float AGENT_SPEED = 2.f;
+const float TICK_SECONDS = 1.f / 30.f;
+
+// Deepest overlap left between two agents
+float max_overlap(const std::vector<glm::vec2>& positions) {
+    collision::spatial_grid grid(1.f);
+    grid.build(positions);
+
+    float deepest = 0.f;
+    for(std::size_t i = 0; i < positions.size(); ++i) {
+        grid.for_each_in_radius(positions[i], AGENT_RADIUS * 2.f, [&](uint32_t other, glm::vec2 position) {
+            if(other != i) {
+                const glm::vec2 diff = position - positions[i];
+                deepest = std::max(deepest, AGENT_RADIUS * 2.f - std::sqrt(diff.x * diff.x + diff.y * diff.y));
+            }
+        });
+    }
+
+    return deepest;
+}
+
+}
+
+int crowd(const arguments& args) {
+    async::task_executor executor(std::max(1u, std::thread::hardware_concurrency()));
+    auto push = [&executor](async::task_executor::task_ptr task) {
+        return executor.push(std::move(task));
+    };
+
+    // Every agent is ordered to the same point, the crowd gets denser every tick
+    for(std::size_t agent_count : {2500, 5000, 10000, 20000}) {
+        std::cout << "crowd of " << agent_count << " units" << std::endl;
+
+        std::mt19937 engine(args.seed);
+        std::uniform_real_distribution<float> distribution(0.f, 200.f);
+        std::vector<glm::vec2> positions(agent_count);
+        for(glm::vec2& position : positions) {
+            position = glm::vec2(distribution(engine), distribution(engine));
+        }
+
+        const std::vector<float> radii(agent_count, AGENT_RADIUS);
+        std::vector<glm::vec2> targets(agent_count, glm::vec2(100.f, 100.f));
+
+        gameplay::separation_system separation;
+        std::vector<double> tick_samples;
+        for(std::size_t i = 0; i < args.iterations; ++i) {
+            for(std::size_t agent = 0; agent < agent_count; ++agent) {
+                const glm::vec2 diff = targets[agent] - positions[agent];
+                const float distance = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+                if(distance > 0.f) {
+                    positions[agent] = distance < AGENT_SPEED * TICK_SECONDS ? targets[agent] : positions[agent] + diff * (AGENT_SPEED * TICK_SECONDS / distance);
+                }
+            }
+
+            game_time::highres_clock tick_clock;
+            const std::vector<glm::vec2>& displacements = separation.solve(positions, radii, push);
+            for(std::size_t agent = 0; agent < agent_count; ++agent) {
+                // Like the units, an agent at rest takes its new position as target
+                const bool is_at_rest = positions[agent] == targets[agent];
+                positions[agent] += displacements[agent];
+                if(is_at_rest) {
+                    targets[agent] = positions[agent];
+                }
+            }
+            tick_samples.push_back(tick_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+        }
+
+        const latency measured(tick_samples);
+        report("separation tick", measured);
+        report("per unit", measured.average_us * 1000.0 / agent_count, "ns");
+        report("deepest overlap", max_overlap(positions) / (AGENT_RADIUS * 2.f) * 100.0, "% of diameter");
+    }
+
+    // Two armies at opposite corners of the map, the area between them must not be paid for
+    {
+        const std::size_t agent_count = 10000;
+        const float MAP_SIZE = 640.f;
+        std::cout << "two armies of " << agent_count / 2 << " units on a " << MAP_SIZE << "x" << MAP_SIZE << " map" << std::endl;
+
+        std::mt19937 engine(args.seed);
+        std::uniform_real_distribution<float> distribution(0.f, 60.f);
+        std::vector<glm::vec2> positions(agent_count);
+        for(std::size_t agent = 0; agent < agent_count; ++agent) {
+            const glm::vec2 offset(distribution(engine), distribution(engine));
+            positions[agent] = agent % 2 == 0 ? offset : glm::vec2(MAP_SIZE, MAP_SIZE) - offset;
+        }
+
+        const std::vector<float> radii(agent_count, AGENT_RADIUS);
+        gameplay::separation_system separation;
+        std::vector<double> tick_samples;
+        for(std::size_t i = 0; i < args.iterations; ++i) {
+            game_time::highres_clock tick_clock;
+            const std::vector<glm::vec2>& displacements = separation.solve(positions, radii, push);
+            for(std::size_t agent = 0; agent < agent_count; ++agent) {
+                positions[agent] += displacements[agent];
+            }
+            tick_samples.push_back(tick_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+        }
+
+        const latency measured(tick_samples);
+        report("separation tick", measured);
+        report("per unit", measured.average_us * 1000.0 / agent_count, "ns");
+    }
+
+    return 0;
+}
+
+}
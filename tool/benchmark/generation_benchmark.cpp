@@ -0,0 +1,75 @@
+#include "benchmark.hpp"
+#include "../../src/common/async/task_executor.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace benchmark {
+
+namespace {
+
+// Summary of the content of every chunk in the order they are stored
+uint64_t fingerprint(const world& w) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+
+    for(const world_chunk& chunk : w) {
+        mix(static_cast<uint32_t>(chunk.position().x));
+        mix(static_cast<uint32_t>(chunk.position().y));
+        for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+            for(int x = 0; x < static_cast<int>(world::CHUNK_WIDTH); ++x) {
+                mix(static_cast<uint64_t>(chunk.biome_at(x, 0, z)));
+                for(const site& s : chunk.sites_at(x, 0, z)) {
+                    mix(static_cast<uint64_t>(s.type()) << 32 | s.amount());
+                }
+            }
+        }
+    }
+
+    return hash;
+}
+
+}
+
+int generation(const arguments& args) {
+    const std::size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "world generation on " << worker_count << " workers" << std::endl;
+
+    async::task_executor executor(worker_count);
+    auto push = [&executor](async::task_executor::task_ptr task) {
+        return executor.push(std::move(task));
+    };
+
+    // Each world is released before the next one is generated
+    for(std::size_t map_size : {args.map_size, std::size_t{64}, std::size_t{128}}) {
+        std::cout << map_size << "x" << map_size << " chunks" << std::endl;
+
+        uint64_t serial_fingerprint;
+        {
+            game_time::highres_clock serial_clock;
+            infinite_world w(args.seed, args.map);
+            generate(w, map_size);
+            report("serial", serial_clock.elapsed_time<std::chrono::microseconds>().count() / 1000.0, "ms");
+            serial_fingerprint = fingerprint(w);
+        }
+
+        uint64_t parallel_fingerprint;
+        {
+            game_time::highres_clock parallel_clock;
+            infinite_world w(args.seed, args.map);
+            w.generate_area(static_cast<int>(map_size), static_cast<int>(map_size), worker_count, push);
+            report("parallel", parallel_clock.elapsed_time<std::chrono::microseconds>().count() / 1000.0, "ms");
+            parallel_fingerprint = fingerprint(w);
+        }
+
+        report("identical worlds", serial_fingerprint == parallel_fingerprint ? 1.0 : 0.0, "");
+    }
+
+    return 0;
+}
+
+}
@@ -0,0 +1,44 @@
+#include "benchmark.hpp"
+
+#include <iostream>
+#include <string>
+
+// Usage: benchmark <scenario> [--size chunks] [--seed seed] [--iterations count] [--map plain|island|lake|river]
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <scenario> [--size chunks] [--seed seed] [--iterations count] [--map type]" << std::endl;
+        std::cerr << "scenarios: pathfinding, combat, crowd, sites, collision, visibility, generation, storage" << std::endl;
+        return 1;
+    }
+
+    const std::string scenario = argv[1];
+    const benchmark::arguments args(argc - 2, argv + 2);
+
+    if(scenario == "pathfinding") {
+        return benchmark::pathfinding(args);
+    }
+    else if(scenario == "combat") {
+        return benchmark::combat(args);
+    }
+    else if(scenario == "crowd") {
+        return benchmark::crowd(args);
+    }
+    else if(scenario == "sites") {
+        return benchmark::sites(args);
+    }
+    else if(scenario == "collision") {
+        return benchmark::collision(args);
+    }
+    else if(scenario == "visibility") {
+        return benchmark::visibility(args);
+    }
+    else if(scenario == "generation") {
+        return benchmark::generation(args);
+    }
+    else if(scenario == "storage") {
+        return benchmark::storage(args);
+    }
+
+    std::cerr << "unknown scenario '" << scenario << "'" << std::endl;
+    return 1;
+}
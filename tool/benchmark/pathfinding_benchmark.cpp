@@ -0,0 +1,85 @@
+#include "benchmark.hpp"
+#include "../../src/common/pathfinding/hierarchical_pathfinder.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace benchmark {
+
+namespace {
+
+// Gives up when the map has almost no tile this movement class can walk on
+const int MAX_TILE_ATTEMPTS = 100000;
+
+bool random_tile(const world& w, movement_class movement, std::size_t map_size, std::mt19937& engine, glm::i32vec2& tile) {
+    std::uniform_int_distribution<int> x_distribution(0, static_cast<int>(map_size * world::CHUNK_WIDTH) - 1);
+    std::uniform_int_distribution<int> z_distribution(0, static_cast<int>(map_size * world::CHUNK_DEPTH) - 1);
+
+    for(int attempt = 0; attempt < MAX_TILE_ATTEMPTS; ++attempt) {
+        tile = glm::i32vec2(x_distribution(engine), z_distribution(engine));
+        const world_chunk* chunk = w.chunk_at(tile.x / world::CHUNK_WIDTH, tile.y / world::CHUNK_DEPTH);
+
+        if(chunk && can_walk_on(movement, chunk->biome_at(tile.x % world::CHUNK_WIDTH, 0, tile.y % world::CHUNK_DEPTH))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
+
+int pathfinding(const arguments& args) {
+    std::cout << "pathfinding on " << args.map_size << "x" << args.map_size << " chunks" << std::endl;
+
+    infinite_world w(args.seed, args.map);
+    generate(w, args.map_size);
+
+    const movement_class land = make_movement_class({biome_type::grass, biome_type::rock, biome_type::snow, biome_type::desert});
+    const movement_class water = make_movement_class({biome_type::water});
+
+    pathfinding::hierarchical_pathfinder pathfinder(w);
+
+    game_time::highres_clock build_clock;
+    pathfinder.build(land);
+    pathfinder.build(water);
+    report("build (land + water)", build_clock.elapsed_time<std::chrono::microseconds>().count() / 1000.0, "ms");
+    report_memory("abstract graphs", pathfinder.memory_usage());
+
+    std::mt19937 engine(args.seed);
+    std::vector<double> query_samples;
+    std::vector<double> refine_samples;
+    std::size_t found_count = 0;
+
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        glm::i32vec2 from;
+        glm::i32vec2 to;
+        if(!random_tile(w, land, args.map_size, engine, from) || !random_tile(w, land, args.map_size, engine, to)) {
+            std::cerr << "no walkable tile found on the map" << std::endl;
+            return 1;
+        }
+
+        game_time::highres_clock query_clock;
+        pathfinding::path found_path = pathfinder.find_path(land, from, to);
+        query_samples.push_back(query_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        if(found_path.found()) {
+            ++found_count;
+
+            game_time::highres_clock refine_clock;
+            while(pathfinder.refine(found_path)) {
+
+            }
+            refine_samples.push_back(refine_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+        }
+    }
+
+    report("paths found", static_cast<double>(found_count), "/ " + std::to_string(args.iterations));
+    report("abstract query", latency(query_samples));
+    report("full refinement", latency(refine_samples));
+
+    return 0;
+}
+
+}
@@ -0,0 +1,138 @@
+#include "benchmark.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace benchmark {
+
+namespace {
+
+const std::size_t NEIGHBOUR_COUNT = 8;
+const float GATHER_RADIUS = 16.f;
+
+// Nearest tile holding the type found by reading every tile of every chunk
+float scan_nearest_distance(const world& w, site::id type, glm::vec2 position) {
+    float nearest_sq = std::numeric_limits<float>::max();
+    for(const world_chunk& chunk : w) {
+        for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+            for(int x = 0; x < static_cast<int>(world::CHUNK_WIDTH); ++x) {
+                for(const site& s : chunk.sites_at(x, 0, z)) {
+                    if(s.type() == type && !s.is_depleted()) {
+                        const glm::vec2 diff = glm::vec2(chunk.position().x * world::CHUNK_WIDTH + x + 0.5f,
+                                                         chunk.position().y * world::CHUNK_DEPTH + z + 0.5f) - position;
+                        nearest_sq = std::min(nearest_sq, diff.x * diff.x + diff.y * diff.y);
+                    }
+                }
+            }
+        }
+    }
+
+    return std::sqrt(nearest_sq);
+}
+
+}
+
+int sites(const arguments& args) {
+    std::cout << "site queries on " << args.map_size << "x" << args.map_size << " chunks" << std::endl;
+
+    infinite_world w(args.seed, args.map);
+    generate(w, args.map_size);
+    report_memory("site index", w.sites().memory_usage());
+
+    std::size_t chunk_bytes = 0;
+    for(const world_chunk& chunk : w) {
+        chunk_bytes += chunk.memory_usage();
+    }
+    report_memory("biomes and sites per chunk", chunk_bytes / static_cast<std::size_t>(args.map_size * args.map_size));
+
+    std::mt19937 engine(args.seed);
+    std::uniform_real_distribution<float> distribution(0.f, static_cast<float>(args.map_size * world::CHUNK_WIDTH));
+    std::uniform_int_distribution<int> type_distribution(SITE_TREE, SITE_STONE);
+
+    std::vector<double> scan_samples;
+    std::vector<double> nearest_samples;
+    std::vector<double> k_nearest_samples;
+    std::vector<double> radius_samples;
+    std::vector<glm::i32vec2> tiles;
+    std::size_t mismatch_count = 0;
+    std::size_t in_radius_count = 0;
+
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        const glm::vec2 position(distribution(engine), distribution(engine));
+        const site::id type = type_distribution(engine);
+
+        // The full scan is far slower, only a sample of the queries is checked against it
+        float scanned_distance = 0.f;
+        const bool is_checked = i % 10 == 0;
+        if(is_checked) {
+            game_time::highres_clock scan_clock;
+            scanned_distance = scan_nearest_distance(w, type, position);
+            scan_samples.push_back(scan_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+        }
+
+        game_time::highres_clock nearest_clock;
+        w.sites().nearest(type, position, std::numeric_limits<float>::max(), 1, tiles);
+        nearest_samples.push_back(nearest_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        if(is_checked && !tiles.empty()) {
+            const glm::vec2 diff = glm::vec2(tiles.front().x + 0.5f, tiles.front().y + 0.5f) - position;
+            if(std::abs(std::sqrt(diff.x * diff.x + diff.y * diff.y) - scanned_distance) > 1e-3f) {
+                ++mismatch_count;
+            }
+        }
+
+        game_time::highres_clock k_nearest_clock;
+        w.sites().nearest(type, position, std::numeric_limits<float>::max(), NEIGHBOUR_COUNT, tiles);
+        k_nearest_samples.push_back(k_nearest_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock radius_clock;
+        w.sites().for_each_in_radius(type, position, GATHER_RADIUS, [&in_radius_count](glm::i32vec2) {
+            ++in_radius_count;
+        });
+        radius_samples.push_back(radius_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+    }
+
+    report("full scan nearest", latency(scan_samples));
+    report("index nearest", latency(nearest_samples));
+    report("index 8 nearest", latency(k_nearest_samples));
+    report("index radius 16", latency(radius_samples));
+    report("sites per radius query", static_cast<double>(in_radius_count) / args.iterations, "tiles");
+    report("nearest mismatches", static_cast<double>(mismatch_count), "queries");
+
+    // Gatherers deplete the nearest trees of random positions
+    std::vector<double> collect_samples;
+    std::size_t stale_count = 0;
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        const glm::vec2 position(distribution(engine), distribution(engine));
+        if(w.sites().nearest(SITE_TREE, position, GATHER_RADIUS, 1, tiles) == 0) {
+            continue;
+        }
+
+        game_time::highres_clock collect_clock;
+        w.collect_site(tiles.front().x, tiles.front().y, SITE_TREE, std::numeric_limits<site::quantity>::max());
+        collect_samples.push_back(collect_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        const glm::i32vec2 tile = tiles.front();
+        const world_chunk* chunk = w.chunk_at(tile.x / world::CHUNK_WIDTH, tile.y / world::CHUNK_DEPTH);
+        bool has_tree = false;
+        for(const site& s : chunk->sites_at(tile.x % world::CHUNK_WIDTH, 0, tile.y % world::CHUNK_DEPTH)) {
+            has_tree = has_tree || (s.type() == SITE_TREE && !s.is_depleted());
+        }
+
+        if(has_tree != w.sites().contains(SITE_TREE, tile.x, tile.y)) {
+            ++stale_count;
+        }
+    }
+
+    if(!collect_samples.empty()) {
+        report("collect until depleted", latency(collect_samples));
+    }
+    report("stale tiles after collect", static_cast<double>(stale_count), "tiles");
+
+    return mismatch_count == 0 && stale_count == 0 ? 0 : 1;
+}
+
+}
@@ -0,0 +1,120 @@
+#include "benchmark.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace benchmark {
+
+namespace {
+
+const std::size_t LOOKUPS_PER_SAMPLE = 4096;
+const std::size_t HOT_CHUNK_COUNT = 64;
+
+struct tile_lookup {
+    const world_chunk* chunk;
+    int x;
+    int z;
+};
+
+// Sum of every biome and site amount of the world, read tile by tile
+uint64_t scan(const world& w) {
+    uint64_t sum = 0;
+    for(const world_chunk& chunk : w) {
+        for(int z = 0; z < static_cast<int>(world::CHUNK_DEPTH); ++z) {
+            for(int x = 0; x < static_cast<int>(world::CHUNK_WIDTH); ++x) {
+                sum += static_cast<uint64_t>(chunk.biome_at(x, 0, z));
+                for(const site& s : chunk.sites_at(x, 0, z)) {
+                    sum += static_cast<uint64_t>(s.type()) * 1000 + s.amount();
+                }
+            }
+        }
+    }
+
+    return sum;
+}
+
+uint64_t measure(const std::string& name, const world& w, const std::vector<tile_lookup>& lookups, std::size_t chunk_count) {
+    std::size_t bytes = 0;
+    for(const world_chunk& chunk : w) {
+        bytes += chunk.memory_usage();
+    }
+
+    std::vector<double> lookup_samples;
+    uint64_t biome_sum = 0;
+    for(std::size_t first = 0; first + LOOKUPS_PER_SAMPLE <= lookups.size(); first += LOOKUPS_PER_SAMPLE) {
+        game_time::highres_clock lookup_clock;
+        for(std::size_t i = first; i < first + LOOKUPS_PER_SAMPLE; ++i) {
+            biome_sum += static_cast<uint64_t>(lookups[i].chunk->biome_at(lookups[i].x, 0, lookups[i].z));
+        }
+        lookup_samples.push_back(lookup_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+    }
+
+    std::vector<double> scan_samples;
+    uint64_t sum = 0;
+    for(int i = 0; i < 10; ++i) {
+        game_time::highres_clock scan_clock;
+        sum = scan(w);
+        scan_samples.push_back(scan_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+    }
+
+    std::cout << name << std::endl;
+    report_memory("per chunk", bytes / chunk_count);
+    report(std::to_string(LOOKUPS_PER_SAMPLE) + " random biome_at", latency(lookup_samples));
+    report("full scan", latency(scan_samples));
+
+    return sum + biome_sum;
+}
+
+}
+
+int storage(const arguments& args) {
+    std::cout << "chunk storage on " << args.map_size << "x" << args.map_size << " chunks" << std::endl;
+
+    infinite_world w(args.seed, args.map);
+    generate(w, args.map_size);
+    const std::size_t chunk_count = args.map_size * args.map_size;
+
+    std::mt19937 engine(args.seed);
+    std::uniform_int_distribution<int> chunk_distribution(0, static_cast<int>(args.map_size) - 1);
+    std::uniform_int_distribution<int> tile_distribution(0, static_cast<int>(world::CHUNK_WIDTH) - 1);
+
+    std::vector<tile_lookup> lookups;
+    std::vector<glm::i32vec2> accessed_chunks;
+    for(std::size_t i = 0; i < args.iterations * 16; ++i) {
+        const world_chunk* chunk = static_cast<const world&>(w).chunk_at(chunk_distribution(engine), chunk_distribution(engine));
+        lookups.push_back(tile_lookup{chunk, tile_distribution(engine), tile_distribution(engine)});
+    }
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        accessed_chunks.emplace_back(chunk_distribution(engine), chunk_distribution(engine));
+    }
+
+    const uint64_t unpacked_sum = measure("unpacked", w, lookups, chunk_count);
+
+    std::vector<double> pack_samples;
+    for(world_chunk& chunk : w) {
+        game_time::highres_clock pack_clock;
+        chunk.pack();
+        pack_samples.push_back(pack_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+    }
+
+    const uint64_t packed_sum = measure("packed", w, lookups, chunk_count);
+    report("pack a chunk", latency(pack_samples));
+
+    // Random changes through the world, the least recently unpacked chunks are packed again
+    w.pack_cold_chunks(HOT_CHUNK_COUNT);
+    std::vector<double> access_samples;
+    for(const glm::i32vec2& position : accessed_chunks) {
+        game_time::highres_clock access_clock;
+        w.chunk_at(position.x, position.y);
+        access_samples.push_back(access_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+    }
+    report("access with " + std::to_string(HOT_CHUNK_COUNT) + " hot chunks", latency(access_samples));
+
+    const uint64_t cached_sum = measure("hot cache", w, lookups, chunk_count);
+    report("identical content", unpacked_sum == packed_sum && packed_sum == cached_sum ? 1.0 : 0.0, "");
+
+    return unpacked_sum == packed_sum && packed_sum == cached_sum ? 0 : 1;
+}
+
+}
@@ -0,0 +1,289 @@
+#include "benchmark.hpp"
+#include "../../src/common/world/visibility_map.hpp"
+#include "../../src/common/world/visibility_tracker.hpp"
+#include "../../src/common/time/clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace benchmark {
+
+namespace {
+
+const std::size_t UNIT_COUNT = 400;
+const float VISIBILITY_RADIUS = 8.f;
+
+// 3 tiles per second at 30 ticks per second
+const float STEP_LENGTH = 0.1f;
+
+const std::size_t PLAYER_COUNT = 8;
+const std::size_t TEAM_COUNT = 2;
+
+// Reference: one byte per tile in a heap row per line, copied into the task and back every tick
+using nested_visibility = std::vector<std::vector<::visibility>>;
+
+void nested_tick(nested_visibility& owned, const std::vector<visibility_tracker::viewer>& viewers) {
+    nested_visibility copy = owned;
+    for(std::vector<::visibility>& row : copy) {
+        std::transform(std::begin(row), std::end(row), std::begin(row), [](::visibility v) {
+            return v == ::visibility::visible ? ::visibility::explored : v;
+        });
+    }
+
+    const int height = static_cast<int>(copy.size());
+    const int width = static_cast<int>(copy.front().size());
+    for(const visibility_tracker::viewer& v : viewers) {
+        const glm::vec2 center(std::floor(v.position.x), std::floor(v.position.y));
+        const int end_of_x = std::min(width - 1, static_cast<int>(center.x + v.radius));
+        const int end_of_y = std::min(height - 1, static_cast<int>(center.y + v.radius));
+        for(int y = std::max(0, static_cast<int>(center.y - v.radius)); y <= end_of_y; ++y) {
+            for(int x = std::max(0, static_cast<int>(center.x - v.radius)); x <= end_of_x; ++x) {
+                if(glm::length(glm::vec2(x, y) - center) <= v.radius) {
+                    copy[y][x] = ::visibility::visible;
+                }
+            }
+        }
+    }
+
+    owned = copy;
+}
+
+void run(std::size_t map_size, float moving_ratio, const arguments& args) {
+    const std::size_t tiles = map_size * world::CHUNK_WIDTH;
+    std::cout << map_size << "x" << map_size << " chunks, " << moving_ratio * 100.f << "% of the units moving" << std::endl;
+
+    std::mt19937 engine(args.seed);
+    std::uniform_real_distribution<float> distribution(0.f, static_cast<float>(tiles));
+    std::uniform_real_distribution<float> ratio_distribution(0.f, 1.f);
+    std::uniform_real_distribution<float> angle_distribution(0.f, 6.2831853f);
+    std::vector<visibility_tracker::viewer> viewers;
+    std::vector<glm::vec2> steps;
+    for(uint32_t i = 0; i < UNIT_COUNT; ++i) {
+        viewers.push_back(visibility_tracker::viewer{i, glm::vec2(distribution(engine), distribution(engine)), VISIBILITY_RADIUS});
+
+        // Units standing still have no step
+        const float angle = angle_distribution(engine);
+        const float step_length = ratio_distribution(engine) < moving_ratio ? STEP_LENGTH : 0.f;
+        steps.emplace_back(std::cos(angle) * step_length, std::sin(angle) * step_length);
+    }
+
+    nested_visibility nested(tiles, std::vector<::visibility>(tiles, ::visibility::unexplored));
+    visibility_map full(tiles, tiles);
+    visibility_map full_next(tiles, tiles);
+    const visibility_stencil stencil(VISIBILITY_RADIUS);
+
+    visibility_tracker tracker(tiles, tiles);
+    visibility_map current(tiles, tiles);
+    visibility_map next(tiles, tiles);
+
+    std::vector<double> nested_samples;
+    std::vector<double> full_samples;
+    std::vector<double> incremental_samples;
+    std::size_t restamped_count = 0;
+    std::size_t mismatch_count = 0;
+    std::uniform_int_distribution<std::size_t> tile_distribution(0, tiles - 1);
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        for(std::size_t unit = 0; unit < viewers.size(); ++unit) {
+            const glm::vec2 position = viewers[unit].position + steps[unit];
+            if(position.x < 0.f || position.y < 0.f || position.x >= tiles || position.y >= tiles) {
+                steps[unit] = glm::vec2(0.f, 0.f) - steps[unit];
+            }
+            else {
+                viewers[unit].position = position;
+            }
+        }
+
+        game_time::highres_clock nested_clock;
+        nested_tick(nested, viewers);
+        nested_samples.push_back(nested_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock full_clock;
+        full_next.advance_from(full);
+        for(const visibility_tracker::viewer& v : viewers) {
+            full_next.reveal(stencil, glm::i32vec2(static_cast<int>(std::floor(v.position.x)), static_cast<int>(std::floor(v.position.y))));
+        }
+        full.swap(full_next);
+        full_samples.push_back(full_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock incremental_clock;
+        tracker.update(viewers, current, next);
+        current.swap(next);
+        incremental_samples.push_back(incremental_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+        restamped_count += tracker.restamped_count();
+
+        // Sampled check, a full comparison would dwarf the ticks
+        for(int sample = 0; sample < 64; ++sample) {
+            const std::size_t x = tile_distribution(engine);
+            const std::size_t y = tile_distribution(engine);
+            mismatch_count += nested[y][x] != full.at(x, y) ? 1 : 0;
+            mismatch_count += nested[y][x] != current.at(x, y) ? 1 : 0;
+        }
+    }
+
+    std::size_t nested_bytes = nested.capacity() * sizeof(std::vector<::visibility>);
+    for(const std::vector<::visibility>& row : nested) {
+        nested_bytes += row.capacity() * sizeof(::visibility);
+    }
+
+    report_memory("nested rows (per map)", nested_bytes);
+    report_memory("bit planes (per map)", current.memory_usage());
+    report_memory("viewer counts", tracker.memory_usage());
+    report("nested tick (copy in and out)", latency(nested_samples));
+    report("bit planes, every unit stamped", latency(full_samples));
+    report("bit planes, moved units stamped", latency(incremental_samples));
+    report("units stamped per tick", static_cast<double>(restamped_count) / args.iterations, "units");
+    report("mismatching tiles", static_cast<double>(mismatch_count), "tiles");
+}
+
+// Players of a team share their vision, spectators see what every player sees
+void shared_vision(std::size_t map_size, const arguments& args) {
+    const std::size_t tiles = map_size * world::CHUNK_WIDTH;
+    const std::size_t chunks = map_size;
+    std::cout << PLAYER_COUNT << " players in " << TEAM_COUNT << " teams on " << map_size << "x" << map_size << " chunks" << std::endl;
+
+    // Every army walks around its base
+    std::mt19937 engine(args.seed);
+    std::uniform_real_distribution<float> base_distribution(tiles * 0.1f, tiles * 0.9f);
+    std::uniform_real_distribution<float> angle_distribution(0.f, 6.2831853f);
+    std::normal_distribution<float> spread_distribution(0.f, tiles / 16.f);
+    std::vector<std::vector<visibility_tracker::viewer>> armies(PLAYER_COUNT);
+    std::vector<glm::vec2> steps;
+    for(std::vector<visibility_tracker::viewer>& army : armies) {
+        const glm::vec2 base(base_distribution(engine), base_distribution(engine));
+        for(uint32_t i = 0; i < UNIT_COUNT / 2; ++i) {
+            const glm::vec2 position = glm::clamp(base + glm::vec2(spread_distribution(engine), spread_distribution(engine)),
+                                                  glm::vec2(0.f, 0.f), glm::vec2(tiles - 1, tiles - 1));
+            army.push_back(visibility_tracker::viewer{i, position, VISIBILITY_RADIUS});
+
+            const float angle = angle_distribution(engine);
+            steps.emplace_back(std::cos(angle) * STEP_LENGTH, std::sin(angle) * STEP_LENGTH);
+        }
+    }
+
+    std::vector<visibility_tracker> trackers(PLAYER_COUNT, visibility_tracker(tiles, tiles));
+    std::vector<visibility_map> current(PLAYER_COUNT, visibility_map(tiles, tiles));
+    std::vector<visibility_map> next(PLAYER_COUNT, visibility_map(tiles, tiles));
+    std::vector<visibility_map> teams(TEAM_COUNT, visibility_map(tiles, tiles));
+    visibility_map spectator(tiles, tiles);
+    visibility_map tile_union(tiles, tiles);
+
+    std::vector<double> player_samples;
+    std::vector<double> team_samples;
+    std::vector<double> tile_union_samples;
+    std::vector<double> chunk_scan_samples;
+    std::vector<double> tile_scan_samples;
+    std::size_t visible_chunk_count = 0;
+    std::size_t mismatch_count = 0;
+    std::uniform_int_distribution<std::size_t> tile_distribution(0, tiles - 1);
+    for(std::size_t i = 0; i < args.iterations; ++i) {
+        std::size_t step = 0;
+        for(std::vector<visibility_tracker::viewer>& army : armies) {
+            for(visibility_tracker::viewer& v : army) {
+                const glm::vec2 position = v.position + steps[step];
+                if(position.x < 0.f || position.y < 0.f || position.x >= tiles || position.y >= tiles) {
+                    steps[step] = glm::vec2(0.f, 0.f) - steps[step];
+                }
+                else {
+                    v.position = position;
+                }
+                ++step;
+            }
+        }
+
+        game_time::highres_clock player_clock;
+        for(std::size_t player = 0; player < PLAYER_COUNT; ++player) {
+            trackers[player].update(armies[player], current[player], next[player]);
+            current[player].swap(next[player]);
+        }
+        player_samples.push_back(player_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock team_clock;
+        for(std::size_t team = 0; team < TEAM_COUNT; ++team) {
+            teams[team] = current[team * PLAYER_COUNT / TEAM_COUNT];
+            for(std::size_t player = team * PLAYER_COUNT / TEAM_COUNT + 1; player < (team + 1) * PLAYER_COUNT / TEAM_COUNT; ++player) {
+                teams[team].merge(current[player]);
+            }
+        }
+        spectator = teams.front();
+        for(std::size_t team = 1; team < TEAM_COUNT; ++team) {
+            spectator.merge(teams[team]);
+        }
+        team_samples.push_back(team_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        // Reference: the spectator built one tile at a time
+        game_time::highres_clock tile_union_clock;
+        for(std::size_t y = 0; y < tiles; ++y) {
+            for(std::size_t x = 0; x < tiles; ++x) {
+                ::visibility seen = ::visibility::unexplored;
+                for(const visibility_map& player : current) {
+                    seen = std::max(seen, player.at(x, y));
+                }
+                tile_union.set(x, y, seen);
+            }
+        }
+        tile_union_samples.push_back(tile_union_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        // Chunks an interest query or the renderer would have to look into
+        game_time::highres_clock chunk_scan_clock;
+        std::size_t chunk_hits = 0;
+        for(std::size_t chunk_y = 0; chunk_y < chunks; ++chunk_y) {
+            for(std::size_t chunk_x = 0; chunk_x < chunks; ++chunk_x) {
+                chunk_hits += spectator.is_chunk_visible(chunk_x, chunk_y) ? 1 : 0;
+            }
+        }
+        chunk_scan_samples.push_back(chunk_scan_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        game_time::highres_clock tile_scan_clock;
+        std::size_t tile_hits = 0;
+        for(std::size_t chunk_y = 0; chunk_y < chunks; ++chunk_y) {
+            for(std::size_t chunk_x = 0; chunk_x < chunks; ++chunk_x) {
+                bool is_visible = false;
+                for(std::size_t y = chunk_y * world::CHUNK_DEPTH; y < (chunk_y + 1) * world::CHUNK_DEPTH && !is_visible; ++y) {
+                    for(std::size_t x = chunk_x * world::CHUNK_WIDTH; x < (chunk_x + 1) * world::CHUNK_WIDTH && !is_visible; ++x) {
+                        is_visible = spectator.is_visible(x, y);
+                    }
+                }
+                tile_hits += is_visible ? 1 : 0;
+            }
+        }
+        tile_scan_samples.push_back(tile_scan_clock.elapsed_time<std::chrono::nanoseconds>().count() / 1000.0);
+
+        visible_chunk_count += chunk_hits;
+        mismatch_count += chunk_hits != tile_hits ? 1 : 0;
+        for(int sample = 0; sample < 64; ++sample) {
+            const std::size_t x = tile_distribution(engine);
+            const std::size_t y = tile_distribution(engine);
+            mismatch_count += spectator.at(x, y) != tile_union.at(x, y) ? 1 : 0;
+        }
+    }
+
+    report_memory("maps of a player (both buffers)", current.front().memory_usage() * 2);
+    report_memory("viewer counts of a player", trackers.front().memory_usage());
+    report("every player updated", latency(player_samples));
+    report("teams and spectator merged", latency(team_samples));
+    report("spectator merged tile by tile", latency(tile_union_samples));
+    report("visible chunks from the masks", latency(chunk_scan_samples));
+    report("visible chunks from the tiles", latency(tile_scan_samples));
+    report("visible chunks", static_cast<double>(visible_chunk_count) / args.iterations, "chunks");
+    report("mismatches", static_cast<double>(mismatch_count), "");
+}
+
+}
+
+int visibility(const arguments& args) {
+    std::cout << "visibility of " << UNIT_COUNT << " units seeing " << VISIBILITY_RADIUS << " tiles away" << std::endl;
+
+    for(std::size_t map_size : {args.map_size, args.map_size * 4}) {
+        for(float moving_ratio : {1.f, 0.1f}) {
+            run(map_size, moving_ratio, args);
+        }
+    }
+
+    shared_vision(args.map_size * 4, args);
+
+    return 0;
+}
+
+}
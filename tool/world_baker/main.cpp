@@ -0,0 +1,98 @@
+#include "../../src/common/async/task_executor.hpp"
+#include "../../src/common/time/clock.hpp"
+#include "../../src/common/world/score_table.hpp"
+#include "../../src/common/world/spawn_search.hpp"
+#include "../../src/common/world/world.hpp"
+#include "../../src/common/world/world_file.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+bool parse_map(const std::string& name, map_choice& map) {
+    if(name == "plain") {
+        map = map_choice::PLAIN_MAP;
+    }
+    else if(name == "island") {
+        map = map_choice::ISLAND_MAP;
+    }
+    else if(name == "lake") {
+        map = map_choice::LAKE_MAP;
+    }
+    else if(name == "river") {
+        map = map_choice::RIVER_MAP;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+// Generates a world offline and saves it where the server looks for it
+int main(int argc, char* argv[]) {
+    map_choice map;
+    if(argc < 3 || !parse_map(argv[1], map)) {
+        std::cerr << "usage: " << argv[0] << " <plain|island|lake|river> <seed> [size] [players] [output]" << std::endl;
+        return 1;
+    }
+
+    const uint32_t seed = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    const int size = argc >= 4 ? std::atoi(argv[3]) : 20;
+    const int player_count = argc >= 5 ? std::atoi(argv[4]) : 2;
+    const std::string path = argc >= 6 ? argv[5] : world_file::path_for(seed, map, size, size);
+    if(size <= 0) {
+        std::cerr << "the size must be a positive number of chunks" << std::endl;
+        return 1;
+    }
+
+    if(player_count <= 0) {
+        std::cerr << "there must be at least one player" << std::endl;
+        return 1;
+    }
+
+    const std::size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    async::task_executor executor(worker_count);
+    auto push = [&executor](async::task_executor::task_ptr task) {
+        return executor.push(std::move(task));
+    };
+
+    std::cout << "baking " << argv[1] << " world of seed " << seed << " on " << size << "x" << size << " chunks..." << std::endl;
+    game_time::highres_clock bake_clock;
+    infinite_world w(seed, map);
+    w.generate_area(size, size, worker_count, push);
+
+    score_table scores;
+    scores.build(w, worker_count, push);
+    const std::vector<glm::i32vec2> spawns = choose_spawn_chunks(w, scores, player_count, worker_count, push);
+    if(!world_file::write(path, w, seed, map, size, size, scores, spawns)) {
+        std::cerr << "cannot write '" << path << "'" << std::endl;
+        return 1;
+    }
+    std::cout << "baked in " << bake_clock.elapsed_time<std::chrono::milliseconds>().count() << " ms" << std::endl;
+
+    // What the server does on its next start
+    game_time::highres_clock load_clock;
+    world_file baked;
+    world loaded;
+    if(!baked.open(path) || !baked.matches(seed, map, size, size)) {
+        std::cerr << "cannot read back '" << path << "'" << std::endl;
+        return 1;
+    }
+    score_table loaded_scores;
+    baked.load_into(loaded);
+    baked.load_scores_into(loaded_scores);
+    std::cout << "loaded '" << path << "' in " << load_clock.elapsed_time<std::chrono::microseconds>().count() / 1000.0 << " ms" << std::endl;
+
+    for(std::size_t player = 0; player < spawns.size(); ++player) {
+        std::cout << "  player #" << player << " spawns at " << spawns[player].x << ", " << spawns[player].y << std::endl;
+    }
+
+    return 0;
+}